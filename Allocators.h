@@ -0,0 +1,351 @@
+#ifndef Allocators_H
+#define Allocators_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <memory_resource>
+
+/**
+ * @brief Arena con allocazione a incremento di puntatore (bump pointer).
+ *
+ * La memoria viene presa a blocchi dall'allocatore globale e ceduta in sequenza;
+ * la deallocazione dei singoli oggetti non fa nulla, mentre reset() rende di nuovo
+ * disponibile tutta la memoria dell'arena, riutilizzando i blocchi già ottenuti.
+ * È adatta a molti SortedArray di breve durata creati e distrutti insieme
+ * (ad esempio durante una singola richiesta).
+ *
+ * Può essere usata direttamente con ArenaAllocator<T> oppure come std::pmr::memory_resource.
+ * Non è thread safe.
+ */
+class Arena final : public std::pmr::memory_resource {
+
+    public:
+
+    /**
+     * @brief Costruttore
+     *
+     * @param blockSize dimensione in byte dei blocchi richiesti all'allocatore globale
+     */
+    explicit Arena(std::size_t blockSize = 64 * 1024)
+        : _first(nullptr), _current(nullptr), _cur(nullptr), _end(nullptr), _blockSize(blockSize) {
+
+    }
+
+    Arena(const Arena &other) = delete;
+    Arena& operator=(const Arena &other) = delete;
+
+    /**
+     * @brief Distruttore: rilascia tutti i blocchi.
+     *
+     */
+    ~Arena(){
+        while(_first != nullptr){
+            block *next = _first->next;
+            ::operator delete(_first);
+            _first = next;
+        }
+    }
+
+    /**
+     * @brief Rende di nuovo disponibile tutta la memoria dell'arena.
+     * Gli oggetti allocati in precedenza non devono più essere utilizzati.
+     *
+     */
+    void reset(){
+        _current = _first;
+        if(_current != nullptr){
+            _cur = _current->data();
+            _end = _cur + _current->size;
+        }
+    }
+
+    protected:
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        char *p = align(_cur, alignment);
+        if(_current == nullptr || p + bytes > _end){
+            nextBlock(bytes + alignment);
+            p = align(_cur, alignment);
+        }
+        _cur = p + bytes;
+        return p;
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {
+
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    private:
+
+    /**
+     * @brief Intestazione di un blocco: i dati seguono immediatamente.
+     *
+     */
+    struct block {
+        block *next;
+        std::size_t size;
+
+        char* data() {
+            return reinterpret_cast<char*>(this) + sizeof(block);
+        }
+    };
+
+    static char* align(char *p, std::size_t alignment){
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    }
+
+    /**
+     * @brief Passa al blocco successivo, riutilizzandolo se abbastanza grande
+     * o inserendone uno nuovo dopo quello corrente.
+     *
+     * @param bytes spazio minimo richiesto nel blocco
+     */
+    void nextBlock(std::size_t bytes){
+        block *next = _current != nullptr ? _current->next : _first;
+        if(next == nullptr || next->size < bytes){
+            std::size_t size = bytes > _blockSize ? bytes : _blockSize;
+            block *b = static_cast<block*>(::operator new(sizeof(block) + size));
+            b->size = size;
+            b->next = next;
+            if(_current != nullptr){
+                _current->next = b;
+            } else {
+                _first = b;
+            }
+            next = b;
+        }
+        _current = next;
+        _cur = _current->data();
+        _end = _cur + _current->size;
+    }
+
+    block *_first;
+    block *_current;
+    char *_cur;
+    char *_end;
+    std::size_t _blockSize;
+
+};
+
+/**
+ * @brief Pool di blocchi di dimensione fissa, suddivisi in classi di potenze di 2.
+ *
+ * Ogni richiesta viene arrotondata alla potenza di 2 successiva e servita dalla lista
+ * dei blocchi liberi della sua classe; i blocchi deallocati tornano nella lista e vengono
+ * riutilizzati dalle allocazioni successive, per cui la crescita geometrica di molti
+ * SortedArray di breve durata non passa per l'allocatore globale. Le richieste più grandi
+ * di maxBlockSize sono inoltrate all'allocatore globale.
+ *
+ * Può essere usato direttamente con PoolAllocator<T> oppure come std::pmr::memory_resource.
+ * Non è thread safe.
+ */
+class Pool final : public std::pmr::memory_resource {
+
+    public:
+
+    /**
+     * @brief Costruttore
+     *
+     * @param maxBlockSize dimensione in byte del blocco più grande servito dal pool;
+     * se è minore di MIN_BLOCK il pool serve comunque la classe di MIN_BLOCK byte
+     * @param slabSize dimensione in byte delle lastre da cui vengono ricavati i blocchi
+     */
+    explicit Pool(std::size_t maxBlockSize = 64 * 1024, std::size_t slabSize = 256 * 1024)
+        : _slabs(nullptr), _cur(nullptr), _end(nullptr), _slabSize(slabSize), _classes(0) {
+
+        for(int i = 0; i < MAX_CLASSES; ++i){
+            _free[i] = nullptr;
+        }
+        while(_classes < MAX_CLASSES && (MIN_BLOCK << _classes) <= maxBlockSize){
+            ++_classes;
+        }
+        if(_classes == 0){
+            _classes = 1;
+        }
+        if(_slabSize < (MIN_BLOCK << (_classes - 1))){
+            _slabSize = MIN_BLOCK << (_classes - 1);
+        }
+    }
+
+    Pool(const Pool &other) = delete;
+    Pool& operator=(const Pool &other) = delete;
+
+    /**
+     * @brief Distruttore: rilascia tutte le lastre.
+     *
+     */
+    ~Pool(){
+        while(_slabs != nullptr){
+            slab *next = _slabs->next;
+            ::operator delete(_slabs);
+            _slabs = next;
+        }
+    }
+
+    protected:
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        int c = sizeClass(bytes);
+        if(c < 0 || alignment > alignof(std::max_align_t)){
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+
+        if(_free[c] != nullptr){
+            node *n = _free[c];
+            _free[c] = n->next;
+            return n;
+        }
+
+        std::size_t size = MIN_BLOCK << c;
+        if(_cur == nullptr || _cur + size > _end){
+            newSlab();
+        }
+        void *p = _cur;
+        _cur += size;
+        return p;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        int c = sizeClass(bytes);
+        if(c < 0 || alignment > alignof(std::max_align_t)){
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+            return;
+        }
+
+        node *n = static_cast<node*>(p);
+        n->next = _free[c];
+        _free[c] = n;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+    private:
+
+    static const int MAX_CLASSES = 32;
+    static const std::size_t MIN_BLOCK = 16;
+
+    struct node {
+        node *next;
+    };
+
+    /**
+     * @brief Intestazione di una lastra, allineata come max_align_t: i blocchi seguono immediatamente.
+     *
+     */
+    struct alignas(std::max_align_t) slab {
+        slab *next;
+    };
+
+    /**
+     * @brief Classe della richiesta: indice della più piccola potenza di 2 (a partire da MIN_BLOCK)
+     * che contiene bytes, o -1 se la richiesta supera il blocco più grande.
+     *
+     * @param bytes dimensione richiesta
+     * @return int classe della richiesta
+     */
+    int sizeClass(std::size_t bytes) const {
+        int c = 0;
+        while(c < _classes && (MIN_BLOCK << c) < bytes){
+            ++c;
+        }
+        return c < _classes ? c : -1;
+    }
+
+    /**
+     * @brief Alloca una nuova lastra da cui ricavare i blocchi.
+     * Lo spazio rimasto nella lastra precedente viene abbandonato.
+     *
+     */
+    void newSlab(){
+        slab *s = static_cast<slab*>(::operator new(sizeof(slab) + _slabSize));
+        s->next = _slabs;
+        _slabs = s;
+        _cur = reinterpret_cast<char*>(s) + sizeof(slab);
+        _end = _cur + _slabSize;
+    }
+
+    slab *_slabs;
+    char *_cur;
+    char *_end;
+    std::size_t _slabSize;
+    int _classes;
+    node *_free[MAX_CLASSES];
+
+};
+
+/**
+ * @brief Allocatore tipizzato che ottiene la memoria da una risorsa R (Arena o Pool).
+ *
+ * A differenza di std::pmr::polymorphic_allocator conosce il tipo concreto della risorsa,
+ * quindi le chiamate non passano per funzioni virtuali. Due allocatori sono uguali
+ * se usano la stessa risorsa, che deve sopravvivere a tutti i contenitori che la usano.
+ *
+ * @tparam T tipo degli oggetti allocati
+ * @tparam R tipo della risorsa di memoria
+ */
+template<typename T, typename R>
+class ResourceAllocator {
+
+    public:
+
+    typedef T value_type;
+
+    ResourceAllocator(R &resource) noexcept : _resource(&resource) {
+
+    }
+
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U, R> &other) noexcept : _resource(other.resource()) {
+
+    }
+
+    T* allocate(std::size_t n){
+        return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n){
+        _resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    R* resource() const noexcept {
+        return _resource;
+    }
+
+    template<typename U>
+    bool operator==(const ResourceAllocator<U, R> &other) const noexcept {
+        return _resource == other.resource();
+    }
+
+    template<typename U>
+    bool operator!=(const ResourceAllocator<U, R> &other) const noexcept {
+        return _resource != other.resource();
+    }
+
+    private:
+
+    R *_resource;
+
+};
+
+/**
+ * @brief Allocatore su Arena: SortedArray<T, C, ArenaAllocator<T> >.
+ *
+ */
+template<typename T>
+using ArenaAllocator = ResourceAllocator<T, Arena>;
+
+/**
+ * @brief Allocatore su Pool: SortedArray<T, C, PoolAllocator<T> >.
+ *
+ */
+template<typename T>
+using PoolAllocator = ResourceAllocator<T, Pool>;
+
+#endif
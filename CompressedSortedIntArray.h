@@ -0,0 +1,615 @@
+#ifndef CompressedSortedIntArray_H
+#define CompressedSortedIntArray_H
+#include "SortedArray.h"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Rappresentazione compressa, in sola lettura, di un array ordinato di int.
+ *
+ * Gli elementi sono divisi in blocchi di BLOCK valori. Per ogni blocco un'intestazione registra
+ * il primo valore, la posizione dei dati compressi, il numero di bit per valore e il numero
+ * di eccezioni; le intestazioni sono contigue, per cui la ricerca binaria trova il blocco
+ * confrontando la chiave con i primi valori e decomprime solo quel blocco.
+ *
+ * Un blocco memorizza le differenze tra valori consecutivi (delta encoding), impacchettate
+ * con lo stesso numero b di bit (frame of reference). b viene scelto per minimizzare lo spazio:
+ * le differenze più lunghe di b bit sono eccezioni, di cui vengono salvati a parte i bit alti
+ * e la posizione (patched FOR). I valori sono impacchettati in 4 corsie intercalate, per cui
+ * la decompressione, specializzata per ogni b, spacchetta con SSE2 4 valori alla volta e ne calcola
+ * la somma prefissa ancora 4 alla volta; nei blocchi senza eccezioni i due passi sono fusi.
+ *
+ * Gli elementi si scorrono con for_each() oppure con gli iteratori di scan(), che decomprime
+ * un blocco alla volta in un buffer del range: gli iteratori contengono solo un puntatore
+ * e l'indice del blocco.
+ *
+ * Limite noto: la scansione non raggiunge la banda di memoria. Nei benchmark compressed/
+ * di bench.cpp (un milione di identificatori con distanza media 4, circa 0,47 byte per
+ * elemento) decompress() costa circa 0,45 ns per elemento, for_each() circa 1,1 ns
+ * e gli iteratori di scan() circa 1,5-2 ns, contro circa 0,5 ns della scansione di un
+ * SortedArray: la decompressione è limitata dal calcolo (spacchettamento e somme prefisse),
+ * non dalla lettura dei dati compressi.
+ *
+ * L'ordine, crescente o decrescente, è quello di comparator_traits<C>, che deve essere noto.
+ *
+ * @tparam C Funtore di ordinamento degli int, con comparator_traits<C>::order diverso da 0
+ */
+template<typename C = std::less<int> >
+class CompressedSortedIntArray{
+
+    static_assert(has_simd_order<int, C>::value, "CompressedSortedIntArray richiede un funtore con ordine noto (comparator_traits)");
+
+    static const bool DESCENDING = comparator_traits<C>::order < 0;
+
+    public:
+
+    typedef int size_type;
+    typedef int value_type;
+    typedef C comparison;
+
+    static const size_type BLOCK = 128;
+
+    class scan_range;
+
+    /**
+     * @brief Iteratore di input, in sola lettura, di uno scan_range: un puntatore al valore
+     * corrente nel buffer del range e l'indice del blocco decompresso. Le copie condividono
+     * il buffer, per cui il range può essere percorso una sola volta.
+     *
+     */
+    class const_iterator {
+
+        public:
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef const int& reference;
+
+        const_iterator(): _value(nullptr), _last(nullptr), _block(0), _range(nullptr) {}
+
+        reference operator*() const {
+            return *_value;
+        }
+
+        pointer operator->() const {
+            return _value;
+        }
+
+        const_iterator& operator++() {
+            if(++_value == _last){
+                _range->load(++_block, *this);
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _value == other._value && _block == other._block;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+
+        private:
+
+        friend class scan_range;
+
+        const int *_value;
+        const int *_last;
+        size_type _block;
+        scan_range *_range;
+    };
+
+    /**
+     * @brief Scansione in ordine dell'array: possiede il buffer in cui viene decompresso
+     * il blocco corrente, per cui gli iteratori non contengono i valori. Non è copiabile;
+     * gli iteratori sono validi finché il range esiste, e begin() ricomincia la scansione.
+     *
+     */
+    class scan_range {
+
+        public:
+
+        scan_range(const scan_range &other) = delete;
+        scan_range& operator=(const scan_range &other) = delete;
+
+        const_iterator begin() {
+            const_iterator it;
+            it._range = this;
+            load(0, it);
+            return it;
+        }
+
+        const_iterator end() {
+            const_iterator it;
+            it._range = this;
+            it._value = _values;
+            it._block = static_cast<size_type>(_owner->_blocks.size());
+            return it;
+        }
+
+        private:
+
+        friend class CompressedSortedIntArray;
+        friend class const_iterator;
+
+        explicit scan_range(const CompressedSortedIntArray *owner): _owner(owner) {}
+
+        /**
+         * @brief Decomprime il blocco k nel buffer e vi posiziona it; oltre l'ultimo blocco
+         * it diventa uguale a end().
+         *
+         */
+        void load(size_type k, const_iterator &it){
+            it._block = k;
+            it._value = _values;
+            it._last = k < static_cast<size_type>(_owner->_blocks.size()) ? _values + _owner->decodeBlock(k, _values) : nullptr;
+        }
+
+        const CompressedSortedIntArray *_owner;
+        int _values[BLOCK];
+    };
+
+    /**
+     * @brief Crea un array vuoto.
+     *
+     */
+    CompressedSortedIntArray(): _size(0) {
+
+    }
+
+    /**
+     * @brief Comprime gli elementi di [first, last), che devono essere ordinati secondo C.
+     *
+     * @tparam Iter tipo degli iteratori
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     */
+    template<typename Iter>
+    CompressedSortedIntArray(Iter first, Iter last): _size(0) {
+        int values[BLOCK];
+        size_type n = 0;
+        for(; first != last; ++first){
+            values[n++] = *first;
+            if(n == BLOCK){
+                encodeBlock(values, n);
+                n = 0;
+            }
+        }
+        if(n > 0){
+            encodeBlock(values, n);
+        }
+        _words.shrink_to_fit();
+        _blocks.shrink_to_fit();
+    }
+
+    /**
+     * @brief Comprime gli elementi di arr.
+     *
+     * @tparam Alloc allocatore di arr
+     * @param arr array da comprimere
+     */
+    template<typename Alloc>
+    explicit CompressedSortedIntArray(const SortedArray<int, C, Alloc> &arr)
+        : CompressedSortedIntArray(arr.data(), arr.data() + arr.size()) {
+
+    }
+
+    /**
+     * @brief Getter del numero di elementi
+     *
+     * @return size_type
+     */
+    size_type size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Byte occupati dalle intestazioni e dai dati compressi.
+     *
+     * @return std::size_t
+     */
+    std::size_t bytes() const {
+        return _blocks.size() * sizeof(block) + _words.size() * sizeof(std::uint32_t);
+    }
+
+    /**
+     * @brief Ritorna true se element è presente.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool encountered(int element) const {
+        size_type k = blocksBefore<false>(element);
+        if(k < static_cast<size_type>(_blocks.size()) && _blocks[k].first == element){
+            return true;
+        }
+        if(k == 0){
+            return false;
+        }
+        int values[BLOCK];
+        size_type n = decodeBlock(k - 1, values);
+        size_type pos = simd_kernels::lowerBound(values, n, element);
+        return pos < n && values[pos] == element;
+    }
+
+    /**
+     * @brief Posizione del primo elemento che non precede element.
+     *
+     * @param element elemento da cercare
+     * @return size_type posizione, size() se tutti gli elementi precedono element
+     */
+    size_type lowerIndex(int element) const {
+        return bound<false>(element);
+    }
+
+    /**
+     * @brief Posizione del primo elemento che segue element.
+     *
+     * @param element elemento da cercare
+     * @return size_type posizione, size() se nessun elemento segue element
+     */
+    size_type upperIndex(int element) const {
+        return bound<true>(element);
+    }
+
+    /**
+     * @brief Numero di elementi uguali ad element.
+     *
+     * @param element elemento da cercare
+     * @return size_type
+     */
+    size_type count(int element) const {
+        return upperIndex(element) - lowerIndex(element);
+    }
+
+    /**
+     * @brief Chiama f su ogni elemento, in ordine, decomprimendo un blocco alla volta.
+     * È il modo più veloce di scorrere l'array.
+     *
+     * @tparam F
+     * @param f funzione chiamata con un int
+     */
+    template<typename F>
+    void for_each(F f) const {
+        int values[BLOCK];
+        for(size_type k = 0; k < static_cast<size_type>(_blocks.size()); ++k){
+            size_type n = decodeBlock(k, values);
+            for(size_type i = 0; i < n; ++i){
+                f(values[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Decomprime gli elementi in un SortedArray, senza riordinarli.
+     *
+     * @return SortedArray<int, C>
+     */
+    SortedArray<int, C> decompress() const {
+        SortedArray<int, C> arr;
+        arr.reserve(_size);
+        int values[BLOCK];
+        for(size_type k = 0; k < static_cast<size_type>(_blocks.size()); ++k){
+            size_type n = decodeBlock(k, values);
+            arr.append_sorted(values, values + n);
+        }
+        return arr;
+    }
+
+    /**
+     * @brief Ritorna un range che scorre gli elementi in ordine con const_iterator,
+     * decomprimendo un blocco alla volta nel proprio buffer.
+     *
+     * @return scan_range
+     */
+    scan_range scan() const {
+        return scan_range(this);
+    }
+
+    private:
+
+    typedef sorted_array_simd<int, DESCENDING> simd_kernels;
+    typedef void (*unpack_function)(const std::uint32_t*, std::uint32_t*);
+
+    /**
+     * @brief Intestazione di un blocco: primo valore, posizione in _words dei valori impacchettati
+     * (bits * BLOCK / 32 parole), seguiti dai bit alti delle eccezioni (una parola ciascuna)
+     * e dalle loro posizioni (un byte ciascuna).
+     *
+     */
+    struct block {
+        std::int32_t first;
+        std::uint32_t offset;
+        std::uint8_t bits;
+        std::uint8_t exceptions;
+    };
+
+    /**
+     * @brief Differenza tra value e il valore precedente nell'ordine dell'array, modulo 2^32.
+     *
+     */
+    static std::uint32_t delta(int previous, int value){
+        return DESCENDING ? static_cast<std::uint32_t>(previous) - static_cast<std::uint32_t>(value)
+                          : static_cast<std::uint32_t>(value) - static_cast<std::uint32_t>(previous);
+    }
+
+    /**
+     * @brief Numero di bit necessari per x.
+     *
+     */
+    static int width(std::uint32_t x){
+#if defined(__GNUC__)
+        return x == 0 ? 0 : 32 - __builtin_clz(x);
+#else
+        int bits = 0;
+        for(; x != 0; x >>= 1){
+            ++bits;
+        }
+        return bits;
+#endif
+    }
+
+    /**
+     * @brief Comprime n valori, n <= BLOCK, in un nuovo blocco. I valori mancanti
+     * vengono completati ripetendo l'ultimo, con differenza 0.
+     *
+     */
+    void encodeBlock(const int *values, size_type n){
+        std::uint32_t deltas[BLOCK];
+        int widths[33] = {};
+        deltas[0] = 0;
+        for(size_type i = 1; i < BLOCK; ++i){
+            assert(i >= n || !C()(values[i], values[i - 1]));
+            deltas[i] = i < n ? delta(values[i - 1], values[i]) : 0;
+            ++widths[width(deltas[i])];
+        }
+
+        // b minimizza i bit impacchettati più 40 bit per ogni eccezione
+        int bits = 32;
+        int exceptions = 0;
+        long best = 32L * BLOCK;
+        int wider = 0;
+        for(int b = 32; b >= 0; --b){
+            long cost = static_cast<long>(b) * BLOCK + 40L * wider;
+            if(cost < best || (cost == best && b < bits)){
+                best = cost;
+                bits = b;
+                exceptions = wider;
+            }
+            wider += widths[b];
+        }
+
+        block header = {values[0], static_cast<std::uint32_t>(_words.size()),
+                        static_cast<std::uint8_t>(bits), static_cast<std::uint8_t>(exceptions)};
+        std::size_t packed = bits * BLOCK / 32;
+        _words.resize(_words.size() + packed + exceptions + (exceptions + 3) / 4, 0);
+        std::uint32_t *out = _words.data() + header.offset;
+        std::uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+        int e = 0;
+        for(size_type i = 0; i < BLOCK; ++i){
+            std::uint32_t low = deltas[i] & mask;
+            if(bits > 0){
+                // il valore i è il valore i / 4 della corsia i % 4, che occupa le parole i % 4 + 4k
+                unsigned pos = (i / 4) * bits;
+                unsigned w = pos / 32;
+                unsigned s = pos % 32;
+                out[4 * w + i % 4] |= low << s;
+                if(s + bits > 32){
+                    out[4 * (w + 1) + i % 4] |= low >> (32 - s);
+                }
+            }
+            if(bits < 32 && (deltas[i] >> bits) != 0){
+                out[packed + e] = deltas[i] >> bits;
+                reinterpret_cast<unsigned char*>(out + packed + exceptions)[e] = static_cast<unsigned char>(i);
+                ++e;
+            }
+        }
+        _blocks.push_back(header);
+        _size += n;
+    }
+
+    /**
+     * @brief Spacchetta BLOCK valori di B bit, disposti in 4 corsie intercalate
+     * (la parola k della corsia l è in[4k + l]) come in SIMD-BP128.
+     *
+     */
+    template<unsigned B>
+    static void unpack(const std::uint32_t *in, std::uint32_t *out){
+        if constexpr(B == 0){
+            std::memset(out, 0, BLOCK * sizeof(std::uint32_t));
+        } else if constexpr(B == 32){
+            std::memcpy(out, in, BLOCK * sizeof(std::uint32_t));
+        } else {
+            // ogni corsia contiene 32 valori in B parole: con il ciclo srotolato spostamenti
+            // e parole lette sono costanti, e ogni passo produce 4 valori consecutivi
+            const std::uint32_t mask = (1u << B) - 1;
+#if defined(SORTEDARRAY_X86)
+            const __m128i m = _mm_set1_epi32(mask);
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 32
+#endif
+            for(unsigned j = 0; j < BLOCK / 4; ++j){
+                const unsigned pos = j * B;
+                const unsigned s = pos % 32;
+                const std::uint32_t *word = in + 4 * (pos / 32);
+#if defined(SORTEDARRAY_X86)
+                __m128i v = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(word)), s);
+                if(s + B > 32){
+                    v = _mm_or_si128(v, _mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(word + 4)), 32 - s));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * j), _mm_and_si128(v, m));
+#else
+                for(unsigned l = 0; l < 4; ++l){
+                    std::uint32_t v = word[l] >> s;
+                    if(s + B > 32){
+                        v |= word[l + 4] << (32 - s);
+                    }
+                    out[4 * j + l] = v & mask;
+                }
+#endif
+            }
+        }
+    }
+
+    /**
+     * @brief Come unpack() seguito da prefixSum(), in un solo passaggio: per i blocchi
+     * senza eccezioni ogni gruppo di 4 differenze viene sommato appena spacchettato,
+     * senza scrivere le differenze in memoria.
+     *
+     */
+    template<unsigned B>
+    static void unpackSum(const std::uint32_t *in, int first, int *values){
+#if defined(SORTEDARRAY_X86)
+        const __m128i m = _mm_set1_epi32(B == 32 ? ~0u : (1u << B) - 1);
+        __m128i carry = _mm_set1_epi32(first);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 32
+#endif
+        for(unsigned j = 0; j < BLOCK / 4; ++j){
+            const unsigned pos = j * B;
+            const unsigned s = pos % 32;
+            const std::uint32_t *word = in + 4 * (pos / 32);
+            __m128i d;
+            if constexpr(B == 0){
+                d = _mm_setzero_si128();
+            } else if constexpr(B == 32){
+                d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(word));
+            } else {
+                d = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(word)), s);
+                if(s + B > 32){
+                    d = _mm_or_si128(d, _mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(word + 4)), 32 - s));
+                }
+                d = _mm_and_si128(d, m);
+            }
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+            __m128i v = DESCENDING ? _mm_sub_epi32(carry, d) : _mm_add_epi32(carry, d);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + 4 * j), v);
+            carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+#else
+        std::uint32_t deltas[BLOCK];
+        unpack<B>(in, deltas);
+        prefixSum(first, deltas, values);
+#endif
+    }
+
+    typedef void (*unpack_sum_function)(const std::uint32_t*, int, int*);
+
+    template<std::size_t... B>
+    static const unpack_function* unpackTable(std::index_sequence<B...>){
+        static const unpack_function table[] = {&unpack<B>...};
+        return table;
+    }
+
+    template<std::size_t... B>
+    static const unpack_sum_function* unpackSumTable(std::index_sequence<B...>){
+        static const unpack_sum_function table[] = {&unpackSum<B>...};
+        return table;
+    }
+
+    /**
+     * @brief Decomprime il blocco k in values.
+     *
+     * @return size_type numero di valori del blocco
+     */
+    size_type decodeBlock(size_type k, int *values) const {
+        const block &header = _blocks[k];
+        const std::uint32_t *in = _words.data() + header.offset;
+        if(header.exceptions == 0){
+            unpackSumTable(std::make_index_sequence<33>())[header.bits](in, header.first, values);
+        } else {
+            std::uint32_t deltas[BLOCK];
+            unpackTable(std::make_index_sequence<33>())[header.bits](in, deltas);
+            std::size_t packed = header.bits * BLOCK / 32;
+            const unsigned char *positions = reinterpret_cast<const unsigned char*>(in + packed + header.exceptions);
+            for(int e = 0; e < header.exceptions; ++e){
+                deltas[positions[e]] |= in[packed + e] << header.bits;
+            }
+            prefixSum(header.first, deltas, values);
+        }
+        return k + 1 < static_cast<size_type>(_blocks.size()) ? BLOCK : _size - k * BLOCK;
+    }
+
+    /**
+     * @brief values[i] = first + deltas[0] + ... + deltas[i] (o first - ..., in ordine
+     * decrescente), modulo 2^32.
+     *
+     */
+    static void prefixSum(int first, const std::uint32_t *deltas, int *values){
+#if defined(SORTEDARRAY_X86)
+        __m128i carry = _mm_set1_epi32(first);
+        for(size_type i = 0; i < BLOCK; i += 4){
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i));
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+            __m128i v = DESCENDING ? _mm_sub_epi32(carry, d) : _mm_add_epi32(carry, d);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), v);
+            carry = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+#else
+        std::uint32_t current = static_cast<std::uint32_t>(first);
+        for(size_type i = 0; i < BLOCK; ++i){
+            current = DESCENDING ? current - deltas[i] : current + deltas[i];
+            values[i] = static_cast<int>(current);
+        }
+#endif
+    }
+
+    /**
+     * @brief Numero di blocchi il cui primo valore precede element (Upper false)
+     * o non lo segue (Upper true), con una ricerca binaria sulle intestazioni.
+     *
+     */
+    template<bool Upper>
+    size_type blocksBefore(int element) const {
+        size_type first = 0;
+        size_type count = _blocks.size();
+        while(count > 0){
+            size_type half = count / 2;
+            int x = _blocks[first + half].first;
+            bool before = Upper ? !C()(element, x) : C()(x, element);
+            first += (half + 1) * before;
+            count = before ? count - half - 1 : half;
+        }
+        return first;
+    }
+
+    /**
+     * @brief Prima posizione il cui elemento non precede element (Upper false) o lo segue (Upper true):
+     * il blocco viene trovato sulle intestazioni, la posizione con simd_kernels sul blocco decompresso.
+     *
+     */
+    template<bool Upper>
+    size_type bound(int element) const {
+        size_type k = blocksBefore<Upper>(element);
+        if(k == 0){
+            return 0;
+        }
+        int values[BLOCK];
+        size_type n = decodeBlock(k - 1, values);
+        size_type pos = Upper ? simd_kernels::upperBound(values, n, element) : simd_kernels::lowerBound(values, n, element);
+        return (k - 1) * BLOCK + pos;
+    }
+
+    std::vector<block> _blocks;
+    std::vector<std::uint32_t> _words;
+    size_type _size;
+
+};
+
+#endif
@@ -0,0 +1,459 @@
+#ifndef ConcurrentSortedArray_H
+#define ConcurrentSortedArray_H
+#include "SortedArray.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief SortedArray condiviso tra più thread, per carichi in cui le letture sono molto
+ * più frequenti delle scritture.
+ *
+ * I lettori ottengono con read() un'istantanea immutabile dell'array, senza acquisire lock:
+ * l'array pubblicato non viene mai modificato, e le scritture ne preparano una copia che
+ * viene poi pubblicata con uno scambio atomico del puntatore (copy-on-write, come in RCU).
+ * Le modifiche vengono accumulate e applicate insieme: push() e remove() vengono registrate
+ * e pubblicate quando ne sono state raccolte batch (o con flush()), per cui il costo
+ * della copia, O(n), viene diviso tra tutte le modifiche del gruppo. Le scritture sono
+ * serializzate da un mutex, che i lettori non usano.
+ *
+ * Le versioni sostituite vengono liberate con un meccanismo a epoche: ogni lettore annuncia,
+ * in uno slot, l'epoca in cui ha iniziato la lettura, e ogni pubblicazione fa avanzare l'epoca.
+ * Una versione sostituita all'epoca r viene liberata quando nessun lettore attivo ha annunciato
+ * un'epoca precedente a r, cioè quando nessuna istantanea può più riferirla. Il controllo avviene
+ * ad ogni pubblicazione e in flush().
+ *
+ * Con la macro SORTEDARRAY_STATS vengono contate solo le operazioni degli scrittori, che lavorano
+ * su una copia privata: le ricerche di un'istantanea non passano dai metodi del SortedArray e non
+ * aggiornano le statistiche della versione condivisa, che altrimenti più lettori scriverebbero
+ * contemporaneamente.
+ *
+ * @tparam T Tipo di dato all'interno dell'array
+ * @tparam C Funtore di ordinamento
+ * @tparam Alloc Allocatore degli elementi
+ */
+template<typename T, typename C, typename Alloc = std::allocator<T> >
+class ConcurrentSortedArray{
+
+    /**
+     * @brief Slot di un lettore: contiene l'epoca annunciata, 0 se libero.
+     * Occupa una linea di cache, per evitare che lettori diversi si contendano la stessa linea.
+     */
+    struct alignas(64) reader_slot {
+        std::atomic<unsigned long> epoch;
+    };
+
+    public:
+
+    typedef SortedArray<T, C, Alloc> array_type;
+    typedef typename array_type::size_type size_type;
+    typedef typename array_type::value_type value_type;
+    typedef sorted_array_simd<T, (comparator_traits<C>::order < 0)> simd_kernels;
+
+    static const std::size_t DEFAULT_BATCH = 1024;
+
+    /**
+     * @brief Istantanea immutabile dell'array, valida finché l'oggetto esiste.
+     * Dà accesso agli elementi in sola lettura e alle ricerche binarie (encountered(), count(),
+     * lower_bound(), upper_bound()), eseguite direttamente sugli elementi e non attraverso i metodi
+     * del SortedArray, per cui non ne aggiornano le statistiche. Mentre esiste, la versione che
+     * riferisce non viene liberata, per cui le istantanee vanno distrutte appena la lettura è terminata.
+     */
+    class snapshot{
+
+        public:
+
+        typedef const value_type* const_iterator;
+
+        snapshot(const snapshot &other) = delete;
+        snapshot& operator=(const snapshot &other) = delete;
+
+        snapshot(snapshot &&other) noexcept: _slot(other._slot), _array(other._array), _cmp(other._cmp) {
+            other._slot = nullptr;
+        }
+
+        /**
+         * @brief Distruttore: termina la lettura, liberando lo slot del lettore.
+         *
+         */
+        ~snapshot(){
+            if(_slot != nullptr){
+                _slot->store(0);
+            }
+        }
+
+        /**
+         * @brief Puntatore al primo elemento dell'istantanea.
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const {
+            return _array->data();
+        }
+
+        /**
+         * @brief Puntatore successivo all'ultimo elemento dell'istantanea.
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const {
+            return begin() + _array->size();
+        }
+
+        /**
+         * @brief Numero di elementi dell'istantanea.
+         *
+         * @return size_type
+         */
+        size_type size() const {
+            return _array->size();
+        }
+
+        /**
+         * @brief Come SortedArray::lower_bound(): primo elemento che non precede element.
+         *
+         * @param element elemento da cercare
+         * @return const_iterator elemento trovato, o end()
+         */
+        const_iterator lower_bound(const value_type &element) const {
+            if constexpr(has_simd_order<T, C>::value){
+                return begin() + simd_kernels::lowerBound(begin(), size(), element);
+            }
+            return std::lower_bound(begin(), end(), element, _cmp);
+        }
+
+        /**
+         * @brief Come SortedArray::upper_bound(): primo elemento che segue element.
+         *
+         * @param element elemento da cercare
+         * @return const_iterator elemento trovato, o end()
+         */
+        const_iterator upper_bound(const value_type &element) const {
+            if constexpr(has_simd_order<T, C>::value){
+                return begin() + simd_kernels::upperBound(begin(), size(), element);
+            }
+            return std::upper_bound(begin(), end(), element, _cmp);
+        }
+
+        /**
+         * @brief Come SortedArray::count(): numero di elementi equivalenti ad element.
+         *
+         * @param element elemento da cercare
+         * @return size_type numero di elementi equivalenti
+         */
+        size_type count(const value_type &element) const {
+            return upper_bound(element) - lower_bound(element);
+        }
+
+        /**
+         * @brief Come SortedArray::encountered(): cerca tra gli elementi equivalenti
+         * ad element uno uguale secondo l'operatore ==.
+         *
+         * @param element elemento da cercare
+         * @return true
+         * @return false
+         */
+        bool encountered(const value_type &element) const {
+            const_iterator first = lower_bound(element);
+            if constexpr(has_simd_order<T, C>::value){
+                // sui tipi aritmetici gli elementi equivalenti sono uguali: basta il lower bound
+                return first != end() && *first == element;
+            }
+            const_iterator last = std::upper_bound(first, end(), element, _cmp);
+            return std::find(first, last, element) != last;
+        }
+
+        private:
+
+        friend class ConcurrentSortedArray;
+
+        snapshot(std::atomic<unsigned long> *slot, const array_type *array)
+            : _slot(slot), _array(array), _cmp(array->value_comp()) {
+
+        }
+
+        std::atomic<unsigned long> *_slot;
+        const array_type *_array;
+        C _cmp;
+    };
+
+    /**
+     * @brief Crea un array condiviso vuoto.
+     *
+     * @param batch numero di modifiche accumulate prima di pubblicare una nuova versione, almeno 1
+     * @param readers numero massimo di letture contemporanee, 0 per 4 per ogni core
+     */
+    explicit ConcurrentSortedArray(std::size_t batch = DEFAULT_BATCH, std::size_t readers = 0)
+        : ConcurrentSortedArray(array_type(), batch, readers) {
+
+    }
+
+    /**
+     * @brief Crea un array condiviso che contiene inizialmente gli elementi di initial.
+     *
+     * @param initial contenuto iniziale
+     * @param batch numero di modifiche accumulate prima di pubblicare una nuova versione, almeno 1
+     * @param readers numero massimo di letture contemporanee, 0 per 4 per ogni core
+     */
+    explicit ConcurrentSortedArray(array_type initial, std::size_t batch = DEFAULT_BATCH, std::size_t readers = 0)
+        : _current(nullptr), _epoch(1), _version(0), _batch(batch > 0 ? batch : 1) {
+        _readerCount = readers > 0 ? readers : 4 * std::max(1u, std::thread::hardware_concurrency());
+        _readers.reset(new reader_slot[_readerCount]);
+        for(std::size_t i = 0; i < _readerCount; ++i){
+            _readers[i].epoch.store(0);
+        }
+        _current.store(new array_type(std::move(initial)));
+    }
+
+    ConcurrentSortedArray(const ConcurrentSortedArray &other) = delete;
+    ConcurrentSortedArray& operator=(const ConcurrentSortedArray &other) = delete;
+
+    /**
+     * @brief Distruttore. Non devono esistere istantanee; le modifiche non ancora
+     * pubblicate vengono scartate.
+     *
+     */
+    ~ConcurrentSortedArray(){
+        delete _current.load();
+        for(const retired &r : _retired){
+            delete r.array;
+        }
+    }
+
+    /**
+     * @brief Inizia una lettura: ritorna un'istantanea dell'ultima versione pubblicata.
+     * Non acquisisce lock; se tutti gli slot dei lettori sono occupati attende che uno si liberi.
+     *
+     * @return snapshot istantanea dell'array
+     */
+    snapshot read() const {
+        unsigned long epoch = _epoch.load();
+        std::size_t first = std::hash<std::thread::id>()(std::this_thread::get_id()) % _readerCount;
+        std::size_t i = first;
+        unsigned long idle = 0;
+        while(!_readers[i].epoch.compare_exchange_strong(idle, epoch)){
+            idle = 0;
+            i = i + 1 == _readerCount ? 0 : i + 1;
+            if(i == first){
+                std::this_thread::yield();
+            }
+        }
+        // l'epoca viene annunciata prima di leggere il puntatore: una versione sostituita
+        // dopo l'annuncio non può essere liberata finché lo slot non torna libero
+        return snapshot(&_readers[i].epoch, _current.load());
+    }
+
+    /**
+     * @brief Come SortedArray::encountered(), sull'ultima versione pubblicata.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool encountered(const value_type &element) const {
+        return read().encountered(element);
+    }
+
+    /**
+     * @brief Numero di elementi dell'ultima versione pubblicata.
+     *
+     * @return size_type
+     */
+    size_type size() const {
+        return read().size();
+    }
+
+    /**
+     * @brief Numero di versioni pubblicate dalla creazione.
+     *
+     * @return unsigned long
+     */
+    unsigned long version() const {
+        return _version.load();
+    }
+
+    /**
+     * @brief Registra l'inserimento di una copia di element; la modifica diventa visibile
+     * ai lettori quando viene pubblicato il gruppo di cui fa parte.
+     *
+     * @param element elemento da inserire
+     */
+    void push(const value_type &element){
+        record(true, element);
+    }
+
+    /**
+     * @brief Come push(const value_type &), ma l'elemento viene spostato.
+     *
+     * @param element elemento da inserire
+     */
+    void push(value_type &&element){
+        record(true, std::move(element));
+    }
+
+    /**
+     * @brief Registra la rimozione di un elemento uguale ad element, come SortedArray::remove().
+     *
+     * @param element elemento da rimuovere
+     */
+    void remove(const value_type &element){
+        record(false, element);
+    }
+
+    /**
+     * @brief Pubblica le modifiche registrate e non ancora pubblicate, e libera le versioni
+     * che nessun lettore può più riferire.
+     * Se l'applicazione delle modifiche solleva un'eccezione, la versione pubblicata
+     * non cambia e le modifiche vengono scartate.
+     *
+     */
+    void flush(){
+        std::lock_guard<std::mutex> lock(_writer);
+        if(!_values.empty()){
+            publish(prepare());
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Applica f ad una copia dell'array, dopo le modifiche registrate, e pubblica il risultato.
+     * Permette di eseguire in una sola pubblicazione qualsiasi modifica del SortedArray
+     * (insert(), filter(), erase(), ...).
+     *
+     * @tparam F tipo della funzione, chiamata con un array_type &
+     * @param f modifica da applicare
+     */
+    template<typename F>
+    void update(F f){
+        std::lock_guard<std::mutex> lock(_writer);
+        std::unique_ptr<array_type> next = prepare();
+        f(*next);
+        publish(std::move(next));
+    }
+
+    private:
+
+    /**
+     * @brief Versione sostituita, da liberare quando nessun lettore ha annunciato
+     * un'epoca precedente a epoch.
+     *
+     */
+    struct retired {
+        const array_type *array;
+        unsigned long epoch;
+    };
+
+    /**
+     * @brief Registra una modifica e pubblica il gruppo se ha raggiunto batch modifiche.
+     *
+     */
+    template<typename V>
+    void record(bool insert, V &&element){
+        std::lock_guard<std::mutex> lock(_writer);
+        _values.push_back(std::forward<V>(element));
+        try{
+            _inserts.push_back(insert);
+        } catch(...){
+            _values.pop_back();
+            throw;
+        }
+        if(_values.size() >= _batch){
+            publish(prepare());
+        }
+    }
+
+    /**
+     * @brief Copia l'ultima versione pubblicata e vi applica le modifiche registrate, nell'ordine
+     * in cui sono state registrate: gli inserimenti consecutivi vengono fusi con l'array
+     * in un solo passaggio con SortedArray::insert(). Le modifiche registrate vengono svuotate
+     * anche in caso di eccezione.
+     *
+     * @return std::unique_ptr<array_type> nuova versione, non ancora pubblicata
+     */
+    std::unique_ptr<array_type> prepare(){
+        try{
+            std::unique_ptr<array_type> next(new array_type(*_current.load()));
+            std::size_t i = 0;
+            while(i < _values.size()){
+                if(!_inserts[i]){
+                    next->remove(_values[i]);
+                    ++i;
+                    continue;
+                }
+                std::size_t j = i;
+                while(j < _values.size() && _inserts[j]){
+                    ++j;
+                }
+                next->insert(std::make_move_iterator(_values.begin() + i), std::make_move_iterator(_values.begin() + j));
+                i = j;
+            }
+            _values.clear();
+            _inserts.clear();
+            return next;
+        } catch(...){
+            _values.clear();
+            _inserts.clear();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Pubblica next come versione corrente e registra la versione sostituita,
+     * con l'epoca successiva alla sostituzione.
+     *
+     * @param next nuova versione
+     */
+    void publish(std::unique_ptr<array_type> next){
+        _retired.reserve(_retired.size() + 1);
+        const array_type *old = _current.exchange(next.release());
+        unsigned long epoch = _epoch.fetch_add(1) + 1;
+        _retired.push_back(retired{old, epoch});
+        ++_version;
+        reclaim();
+    }
+
+    /**
+     * @brief Libera le versioni sostituite che nessun lettore attivo può riferire:
+     * un lettore che ha annunciato un'epoca non precedente a quella della sostituzione
+     * ha letto il puntatore dopo la sostituzione.
+     *
+     */
+    void reclaim(){
+        unsigned long oldest = ULONG_MAX;
+        for(std::size_t i = 0; i < _readerCount; ++i){
+            unsigned long epoch = _readers[i].epoch.load();
+            if(epoch != 0 && epoch < oldest){
+                oldest = epoch;
+            }
+        }
+        std::size_t kept = 0;
+        for(std::size_t i = 0; i < _retired.size(); ++i){
+            if(_retired[i].epoch <= oldest){
+                delete _retired[i].array;
+            } else {
+                _retired[kept++] = _retired[i];
+            }
+        }
+        _retired.resize(kept);
+    }
+
+    std::atomic<const array_type*> _current;
+    std::atomic<unsigned long> _epoch;
+    std::atomic<unsigned long> _version;
+    std::unique_ptr<reader_slot[]> _readers;
+    std::size_t _readerCount;
+    std::size_t _batch;
+    std::mutex _writer;
+    std::vector<value_type> _values;
+    std::vector<bool> _inserts;
+    std::vector<retired> _retired;
+
+};
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef LogSortedArray_H
+#define LogSortedArray_H
+#include "SortedArray.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Variante di SortedArray ottimizzata per le scritture, organizzata come un
+ * log-structured merge tree (LSM).
+ *
+ * Gli elementi inseriti vengono accodati, senza ordinarli, in un buffer di delta elementi.
+ * Quando il buffer è pieno viene ordinato e diventa il livello 0; se il livello 0 è già
+ * occupato i due vengono fusi con un passaggio lineare e il risultato sale al livello 1,
+ * e così via, come in un contatore binario: il livello i contiene circa delta * 2^i elementi,
+ * e ogni elemento viene fuso O(log(n / delta)) volte, per cui push() costa O(log n) ammortizzato
+ * invece degli O(n) spostamenti di SortedArray::push().
+ *
+ * Le ricerche controllano il buffer e ogni livello. Se Hash non è void, ogni livello ha un filtro
+ * di Bloom costruito con Hash, e i livelli il cui filtro esclude l'elemento non vengono cercati;
+ * Hash deve assegnare lo stesso valore ad elementi uguali secondo l'operatore ==.
+ *
+ * begin() e compact() fondono buffer e livelli in un solo SortedArray, di cui vengono restituiti
+ * gli iteratori: conviene chiamare compact() prima delle fasi con molte letture. Tra elementi
+ * equivalenti l'ordine è quello di inserimento, come in SortedArray::push().
+ *
+ * @tparam T Tipo di dato all'interno dell'array
+ * @tparam C Funtore di ordinamento
+ * @tparam Hash Funtore di hash per i filtri di Bloom, void per non usarli
+ * @tparam Alloc Allocatore degli elementi
+ */
+template<typename T, typename C, typename Hash = void, typename Alloc = std::allocator<T> >
+class LogSortedArray{
+
+    public:
+
+    typedef SortedArray<T, C, Alloc> array_type;
+    typedef typename array_type::size_type size_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::iterator iterator;
+    typedef Alloc allocator_type;
+
+    static const size_type DEFAULT_DELTA = 256;
+
+    /**
+     * @brief Crea un array vuoto.
+     *
+     * @param delta dimensione del buffer degli inserimenti, almeno 1
+     * @param alloc allocatore da utilizzare
+     */
+    explicit LogSortedArray(size_type delta = DEFAULT_DELTA, const allocator_type &alloc = allocator_type())
+        : _delta(delta > 0 ? delta : 1), _alloc(alloc), _buffer(alloc) {
+        _buffer.reserve(_delta);
+    }
+
+    /**
+     * @brief Aggiunge una copia di element. L'elemento viene accodato al buffer, che viene
+     * ordinato e fuso con i livelli quando è pieno.
+     *
+     * @param element elemento da aggiungere
+     */
+    void push(const value_type &element){
+        _buffer.push_back(element);
+        if(static_cast<size_type>(_buffer.size()) >= _delta){
+            flushBuffer();
+        }
+    }
+
+    /**
+     * @brief Come push(const value_type &), ma l'elemento viene spostato.
+     *
+     * @param element elemento da aggiungere
+     */
+    void push(value_type &&element){
+        _buffer.push_back(std::move(element));
+        if(static_cast<size_type>(_buffer.size()) >= _delta){
+            flushBuffer();
+        }
+    }
+
+    /**
+     * @brief Ritorna true se un elemento uguale ad element (operatore == const) è presente.
+     * Il buffer viene scandito, i livelli vengono cercati con SortedArray::encountered()
+     * saltando quelli esclusi dal filtro di Bloom.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool encountered(const value_type &element) const {
+        for(const value_type &x : _buffer){
+            if(x == element){
+                return true;
+            }
+        }
+        std::uint64_t hash = hashOf(element);
+        for(const level &l : _levels){
+            if(l.elements.size() > 0 && l.mayContain(hash) && l.elements.encountered(element)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Rimuove il primo elemento uguale ad element nell'ordine di iterazione:
+     * tra elementi equivalenti il meno recente, cercato quindi a partire dal livello più vecchio.
+     * Ogni livello viene cercato una sola volta, con SortedArray::remove().
+     * I filtri di Bloom non vengono aggiornati, per cui possono segnalare elementi rimossi.
+     *
+     * @param element elemento da rimuovere
+     */
+    void remove(const value_type &element){
+        std::uint64_t hash = hashOf(element);
+        for(size_type i = _levels.size(); i > 0; --i){
+            level &l = _levels[i - 1];
+            if(l.elements.size() > 0 && l.mayContain(hash) && l.elements.remove(element)){
+                return;
+            }
+        }
+        for(typename buffer_type::iterator it = _buffer.begin(); it != _buffer.end(); ++it){
+            if(*it == element){
+                _buffer.erase(it);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Rimuove gli elementi che soddisfano la condizione F, dal buffer e da ogni livello.
+     *
+     * @tparam F
+     * @param parameter
+     * @return size_type numero di elementi rimossi
+     */
+    template<typename F>
+    size_type filter(F parameter){
+        size_type removed = 0;
+        typename buffer_type::iterator kept = std::remove_if(_buffer.begin(), _buffer.end(), parameter);
+        removed += _buffer.end() - kept;
+        _buffer.erase(kept, _buffer.end());
+        for(level &l : _levels){
+            removed += l.elements.filter(parameter);
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Fonde buffer e livelli in un solo SortedArray, l'ultimo livello, in tempo lineare
+     * nel numero di elementi (i livelli vengono fusi dal più piccolo al più grande).
+     *
+     */
+    void compact(){
+        array_type merged = sortedBuffer();
+        for(level &l : _levels){
+            if(l.elements.size() > 0){
+                merged = l.elements.merge(std::move(merged));
+                l.bloom.clear();
+            }
+        }
+        if(_levels.empty()){
+            _levels.emplace_back(_alloc);
+        }
+        _levels.back().elements.swap(merged);
+        buildBloom(_levels.back());
+    }
+
+    /**
+     * @brief Ritorna un iteratore al primo elemento, dopo aver compattato l'array con compact().
+     * Gli iteratori vengono invalidati da ogni modifica.
+     *
+     * @return iterator
+     */
+    iterator begin(){
+        compactIfNeeded();
+        return _levels.back().elements.begin();
+    }
+
+    /**
+     * @brief Ritorna un iteratore alla fine dell'array, dopo averlo compattato con compact().
+     *
+     * @return iterator
+     */
+    iterator end(){
+        compactIfNeeded();
+        return _levels.back().elements.end();
+    }
+
+    /**
+     * @brief Numero di elementi, nel buffer e nei livelli.
+     *
+     * @return size_type
+     */
+    size_type size() const {
+        size_type n = _buffer.size();
+        for(const level &l : _levels){
+            n += l.elements.size();
+        }
+        return n;
+    }
+
+    /**
+     * @brief Numero di livelli non vuoti.
+     *
+     * @return size_type
+     */
+    size_type levels() const {
+        size_type n = 0;
+        for(const level &l : _levels){
+            n += l.elements.size() > 0;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Svuota l'array.
+     *
+     */
+    void toEmpty(){
+        _buffer.clear();
+        _levels.clear();
+    }
+
+    private:
+
+    typedef std::vector<value_type, Alloc> buffer_type;
+
+    /**
+     * @brief Bit del filtro di Bloom per elemento e numero di bit impostati per elemento:
+     * la probabilità di un falso positivo è circa il 2%.
+     *
+     */
+    static const std::size_t BLOOM_BITS = 8;
+    static const int BLOOM_HASHES = 5;
+
+    /**
+     * @brief Livello: elementi ordinati e, se Hash non è void, il loro filtro di Bloom.
+     *
+     */
+    struct level {
+
+        explicit level(const allocator_type &alloc): elements(alloc) {}
+
+        /**
+         * @brief Ritorna false se il filtro esclude l'elemento di hash dato.
+         *
+         */
+        bool mayContain(std::uint64_t hash) const {
+            if(bloom.empty()){
+                return true;
+            }
+            std::uint64_t bits = bloom.size() * 64;
+            std::uint64_t step = (hash >> 32) | 1;
+            for(int k = 0; k < BLOOM_HASHES; ++k, hash += step){
+                std::uint64_t bit = hash % bits;
+                if(!(bloom[bit / 64] & (std::uint64_t(1) << (bit % 64)))){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        array_type elements;
+        std::vector<std::uint64_t> bloom;
+    };
+
+    /**
+     * @brief Hash di element per i filtri di Bloom, rimescolato in modo che
+     * entrambe le metà a 32 bit siano utilizzabili. 0 se Hash è void.
+     *
+     */
+    static std::uint64_t hashOf(const value_type &element){
+        if constexpr(std::is_void<Hash>::value){
+            return 0;
+        } else {
+            std::uint64_t h = static_cast<std::uint64_t>(Hash()(element));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+    }
+
+    /**
+     * @brief Costruisce il filtro di Bloom del livello, se Hash non è void.
+     *
+     */
+    static void buildBloom(level &l){
+        l.bloom.clear();
+        if constexpr(!std::is_void<Hash>::value){
+            size_type n = l.elements.size();
+            if(n == 0){
+                return;
+            }
+            l.bloom.assign((n * BLOOM_BITS + 63) / 64, 0);
+            std::uint64_t bits = l.bloom.size() * 64;
+            for(const value_type &x : l.elements){
+                std::uint64_t hash = hashOf(x);
+                std::uint64_t step = (hash >> 32) | 1;
+                for(int k = 0; k < BLOOM_HASHES; ++k, hash += step){
+                    std::uint64_t bit = hash % bits;
+                    l.bloom[bit / 64] |= std::uint64_t(1) << (bit % 64);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Ordina il buffer in un SortedArray e lo svuota.
+     *
+     * @return array_type elementi del buffer, in ordine
+     */
+    array_type sortedBuffer(){
+        array_type sorted(_alloc);
+        sorted.reserve(_buffer.size());
+        sorted.insert(std::make_move_iterator(_buffer.begin()), std::make_move_iterator(_buffer.end()));
+        _buffer.clear();
+        return sorted;
+    }
+
+    /**
+     * @brief Porta il buffer pieno nei livelli: a partire dal livello 0, ogni livello occupato
+     * viene fuso con gli elementi provenienti dai livelli inferiori, che sono più recenti
+     * e lo seguono quindi tra gli elementi equivalenti.
+     *
+     */
+    void flushBuffer(){
+        array_type run = sortedBuffer();
+        std::size_t i = 0;
+        for(; i < _levels.size() && _levels[i].elements.size() > 0; ++i){
+            run = _levels[i].elements.merge(std::move(run));
+            _levels[i].bloom.clear();
+        }
+        if(i == _levels.size()){
+            _levels.emplace_back(_alloc);
+        }
+        _levels[i].elements.swap(run);
+        buildBloom(_levels[i]);
+    }
+
+    /**
+     * @brief Chiama compact() se l'array non è già formato da un solo livello, l'ultimo.
+     *
+     */
+    void compactIfNeeded(){
+        if(_levels.empty() || !_buffer.empty() || levels() > (_levels.back().elements.size() > 0 ? 1 : 0)){
+            compact();
+        }
+    }
+
+    size_type _delta;
+    allocator_type _alloc;
+    buffer_type _buffer;
+    std::vector<level> _levels;
+
+};
+
+#endif
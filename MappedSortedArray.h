@@ -0,0 +1,437 @@
+#ifndef MappedSortedArray_H
+#define MappedSortedArray_H
+#include "SortedArray.h"
+#include "SortedArraySerialization.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SORTEDARRAY_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Intestazione dei file di MappedSortedArray, seguita a partire da dataOffset
+ * dagli elementi, ordinati, nella loro rappresentazione in memoria.
+ *
+ */
+struct sorted_array_file_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t elementSize;
+    std::uint32_t elementAlign;
+    std::uint64_t count;
+    std::uint64_t comparatorTag;
+    std::uint64_t dataOffset;
+};
+
+/**
+ * @brief SortedArray persistente di un tipo trivially copyable, salvato su file con save()
+ * e riaperto con mmap senza copiare né riordinare gli elementi: l'apertura costa O(1)
+ * indipendentemente dal numero di elementi, che vengono letti dal disco solo quando servono.
+ *
+ * Finché l'array non viene modificato ricerche e iterazione lavorano in sola lettura sulla mappatura.
+ * La prima modifica (mutate(), push(), remove(), filter()) copia gli elementi in un SortedArray
+ * e rilascia la mappatura: il file non viene mai modificato, per aggiornarlo si chiama save().
+ *
+ * L'intestazione registra dimensione e allineamento degli elementi, numero di elementi,
+ * ordine dei byte e comparator_tag<C>: l'apertura di un file incompatibile solleva std::runtime_error.
+ * Sulle piattaforme senza mmap il file viene letto in un SortedArray all'apertura.
+ *
+ * @tparam T Tipo di dato all'interno dell'array, trivially copyable
+ * @tparam C Funtore di ordinamento
+ * @tparam Alloc Allocatore degli elementi dopo la prima modifica
+ */
+template<typename T, typename C, typename Alloc = std::allocator<T> >
+class MappedSortedArray{
+
+    static_assert(std::is_trivially_copyable<T>::value, "MappedSortedArray richiede un tipo trivially copyable");
+    static_assert(alignof(T) <= 64, "allineamento degli elementi non supportato");
+
+    public:
+
+    typedef SortedArray<T, C, Alloc> array_type;
+    typedef typename array_type::size_type size_type;
+    typedef T value_type;
+    typedef C comparison;
+    typedef Alloc allocator_type;
+    typedef const T* const_iterator;
+
+    static const std::uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Apre in sola lettura un file scritto da save().
+     *
+     * @param path percorso del file
+     * @param alloc allocatore usato dopo la prima modifica
+     * @throws std::runtime_error se il file non può essere aperto o non è compatibile con T e C
+     */
+    explicit MappedSortedArray(const std::string &path, const allocator_type &alloc = allocator_type())
+        : _mapping(nullptr), _mappedBytes(0), _elements(nullptr), _size(0), _heap(alloc) {
+        open(path);
+    }
+
+    MappedSortedArray(const MappedSortedArray &other) = delete;
+    MappedSortedArray& operator=(const MappedSortedArray &other) = delete;
+
+    /**
+     * @brief Move constructor: la mappatura passa al nuovo oggetto, other rimane vuoto.
+     *
+     * @param other array da spostare
+     */
+    MappedSortedArray(MappedSortedArray &&other) noexcept
+        : _mapping(other._mapping), _mappedBytes(other._mappedBytes), _elements(other._elements),
+          _size(other._size), _heap(std::move(other._heap)) {
+        other._mapping = nullptr;
+        other._mappedBytes = 0;
+        other._elements = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     * @brief Distruttore: rilascia la mappatura.
+     *
+     */
+    ~MappedSortedArray(){
+        unmap();
+    }
+
+    /**
+     * @brief Scrive arr in path. Il file viene prima scritto con un nome temporaneo e poi
+     * rinominato, per cui un file preesistente, anche se mappato, non viene mai lasciato a metà.
+     *
+     * @param path percorso del file
+     * @param arr array da salvare
+     * @throws std::runtime_error se la scrittura non riesce
+     */
+    static void save(const std::string &path, const array_type &arr){
+        write(path, arr.data(), arr.size());
+    }
+
+    /**
+     * @brief Scrive gli elementi attuali in path, come save(const std::string &, const array_type &).
+     *
+     * @param path percorso del file
+     */
+    void save(const std::string &path) const {
+        write(path, begin(), size());
+    }
+
+    /**
+     * @brief Ritorna true finché l'array legge gli elementi dalla mappatura del file.
+     *
+     * @return true
+     * @return false dopo la prima modifica
+     */
+    bool mapped() const {
+        return _mapping != nullptr;
+    }
+
+    /**
+     * @brief Getter del numero di elementi
+     *
+     * @return size_type
+     */
+    size_type size() const {
+        return mapped() ? _size : _heap.size();
+    }
+
+    /**
+     * @brief Primo elemento, in sola lettura.
+     *
+     * @return const_iterator
+     */
+    const_iterator begin() const {
+        return mapped() ? _elements : _heap.data();
+    }
+
+    /**
+     * @brief Fine dell'array, in sola lettura.
+     *
+     * @return const_iterator
+     */
+    const_iterator end() const {
+        return begin() + size();
+    }
+
+    /**
+     * @brief Ritorna true se un elemento uguale ad element (operatore ==) è presente.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool encountered(const value_type &element) const {
+        for(const_iterator it = lower_bound(element); it != end() && !_cmp(element, *it); ++it){
+            // come in SortedArray, l'operatore == di T può non essere const
+            if(const_cast<value_type&>(*it) == element){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Primo elemento che non precede element.
+     *
+     * @param element elemento da cercare
+     * @return const_iterator
+     */
+    const_iterator lower_bound(const value_type &element) const {
+        if constexpr(has_simd_order<T, C>::value){
+            return begin() + simd_kernels::lowerBound(begin(), size(), element);
+        } else {
+            return std::lower_bound(begin(), end(), element, _cmp);
+        }
+    }
+
+    /**
+     * @brief Primo elemento che segue element.
+     *
+     * @param element elemento da cercare
+     * @return const_iterator
+     */
+    const_iterator upper_bound(const value_type &element) const {
+        if constexpr(has_simd_order<T, C>::value){
+            return begin() + simd_kernels::upperBound(begin(), size(), element);
+        } else {
+            return std::upper_bound(begin(), end(), element, _cmp);
+        }
+    }
+
+    /**
+     * @brief Primo elemento equivalente ad element.
+     *
+     * @param element elemento da cercare
+     * @return const_iterator elemento trovato, o end() se assente
+     */
+    const_iterator find(const value_type &element) const {
+        const_iterator it = lower_bound(element);
+        return it != end() && !_cmp(element, *it) ? it : end();
+    }
+
+    /**
+     * @brief Numero di elementi equivalenti ad element.
+     *
+     * @param element elemento da cercare
+     * @return size_type
+     */
+    size_type count(const value_type &element) const {
+        return upper_bound(element) - lower_bound(element);
+    }
+
+    /**
+     * @brief Copia gli elementi in memoria, se sono ancora mappati, e ritorna il SortedArray
+     * che li contiene, su cui è possibile qualsiasi modifica. La copia è lineare e non riordina.
+     *
+     * @return array_type&
+     */
+    array_type& mutate(){
+        if(mapped()){
+            array_type heap(_heap.get_allocator());
+            heap.reserve(_size);
+            heap.append_sorted(_elements, _elements + _size);
+            unmap();
+            _heap.swap(heap);
+        }
+        return _heap;
+    }
+
+    /**
+     * @brief Inserisce element come SortedArray::push(), dopo aver chiamato mutate().
+     *
+     * @param element elemento da inserire
+     */
+    void push(const value_type &element){
+        mutate().push(element);
+    }
+
+    /**
+     * @brief Rimuove element come SortedArray::remove(), dopo aver chiamato mutate().
+     *
+     * @param element elemento da rimuovere
+     */
+    void remove(const value_type &element){
+        mutate().remove(element);
+    }
+
+    /**
+     * @brief Rimuove gli elementi che soddisfano la condizione F come SortedArray::filter(),
+     * dopo aver chiamato mutate().
+     *
+     * @tparam F
+     * @param parameter
+     * @return size_type numero di elementi rimossi
+     */
+    template<typename F>
+    size_type filter(F parameter){
+        return mutate().filter(parameter);
+    }
+
+    private:
+
+    typedef sorted_array_simd<T, (comparator_traits<C>::order < 0)> simd_kernels;
+
+    static const char* magic(){
+        return "SORTARR";
+    }
+
+    static std::uint32_t byteOrder(){
+        return 0x01020304;
+    }
+
+    /**
+     * @brief Primo multiplo di 64 byte dopo l'intestazione: gli elementi mappati sono allineati.
+     *
+     */
+    static std::uint64_t dataOffset(){
+        return (sizeof(sorted_array_file_header) + 63) / 64 * 64;
+    }
+
+    static void write(const std::string &path, const value_type *elements, size_type n){
+        sorted_array_file_header header = {};
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.version = FORMAT_VERSION;
+        header.byteOrder = byteOrder();
+        header.elementSize = sizeof(T);
+        header.elementAlign = alignof(T);
+        header.count = n;
+        header.comparatorTag = comparator_tag<C>::value();
+        header.dataOffset = dataOffset();
+
+        std::string tmp = path + ".tmp";
+        std::FILE *file = std::fopen(tmp.c_str(), "wb");
+        if(!file){
+            throw std::runtime_error("impossibile creare " + tmp);
+        }
+        static const char padding[64] = {};
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(padding, 1, dataOffset() - sizeof(header), file) == dataOffset() - sizeof(header) &&
+            (n == 0 || std::fwrite(elements, sizeof(T), n, file) == static_cast<std::size_t>(n));
+        ok = std::fclose(file) == 0 && ok;
+        if(!ok || std::rename(tmp.c_str(), path.c_str()) != 0){
+            std::remove(tmp.c_str());
+            throw std::runtime_error("impossibile scrivere " + path);
+        }
+    }
+
+    /**
+     * @brief Verifica l'intestazione e ritorna il numero di elementi.
+     *
+     */
+    static size_type check(const sorted_array_file_header &header, std::uint64_t fileSize, const std::string &path){
+        if(std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 || header.version != FORMAT_VERSION){
+            throw std::runtime_error(path + ": formato non riconosciuto");
+        }
+        if(header.byteOrder != byteOrder() || header.elementSize != sizeof(T) || header.elementAlign != alignof(T)){
+            throw std::runtime_error(path + ": tipo degli elementi incompatibile");
+        }
+        if(header.comparatorTag != comparator_tag<C>::value()){
+            throw std::runtime_error(path + ": funtore di ordinamento diverso");
+        }
+        if(header.dataOffset != dataOffset() || header.count > static_cast<std::uint64_t>(std::numeric_limits<size_type>::max()) ||
+           fileSize < header.dataOffset + header.count * sizeof(T)){
+            throw std::runtime_error(path + ": file troncato o danneggiato");
+        }
+        return static_cast<size_type>(header.count);
+    }
+
+#if defined(SORTEDARRAY_MMAP)
+
+    void open(const std::string &path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error("impossibile aprire " + path);
+        }
+        struct stat info;
+        if(::fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(sorted_array_file_header)){
+            ::close(fd);
+            throw std::runtime_error(path + ": file troncato o danneggiato");
+        }
+        std::size_t bytes = info.st_size;
+        void *mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(mapping == MAP_FAILED){
+            throw std::runtime_error("impossibile mappare " + path);
+        }
+        const sorted_array_file_header &header = *static_cast<const sorted_array_file_header*>(mapping);
+        try{
+            _size = check(header, bytes, path);
+        } catch(...){
+            ::munmap(mapping, bytes);
+            throw;
+        }
+        _mapping = mapping;
+        _mappedBytes = bytes;
+        _elements = reinterpret_cast<const value_type*>(static_cast<const char*>(mapping) + header.dataOffset);
+    }
+
+    void unmap(){
+        if(_mapping){
+            ::munmap(_mapping, _mappedBytes);
+            _mapping = nullptr;
+            _mappedBytes = 0;
+            _elements = nullptr;
+            _size = 0;
+        }
+    }
+
+#else
+
+    void open(const std::string &path){
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if(!file){
+            throw std::runtime_error("impossibile aprire " + path);
+        }
+        sorted_array_file_header header;
+        long bytes = -1;
+        if(std::fread(&header, sizeof(header), 1, file) == 1 && std::fseek(file, 0, SEEK_END) == 0){
+            bytes = std::ftell(file);
+        }
+        bool ok = false;
+        try{
+            if(bytes < 0){
+                throw std::runtime_error(path + ": file troncato o danneggiato");
+            }
+            size_type n = check(header, bytes, path);
+            // gli elementi vengono letti direttamente nella memoria di _heap, riservata una sola volta
+            _heap.reserve(n);
+            ok = std::fseek(file, static_cast<long>(header.dataOffset), SEEK_SET) == 0 &&
+                _heap.append_sorted_raw(n, [file, n](value_type *elements){
+                    return std::fread(elements, sizeof(T), n, file) == static_cast<std::size_t>(n);
+                });
+        } catch(...){
+            std::fclose(file);
+            throw;
+        }
+        std::fclose(file);
+        if(!ok){
+            throw std::runtime_error("impossibile leggere " + path);
+        }
+    }
+
+    void unmap(){
+
+    }
+
+#endif
+
+    void *_mapping;
+    std::size_t _mappedBytes;
+    const value_type *_elements;
+    size_type _size;
+    array_type _heap;
+    C _cmp;
+
+};
+
+#endif
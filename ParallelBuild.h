@@ -0,0 +1,220 @@
+#ifndef ParallelBuild_H
+#define ParallelBuild_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Insieme di thread che eseguono in parallelo le fasi della costruzione
+ * di un SortedArray (vedi SortedArray::sort(Executor &)).
+ *
+ * ThreadPool è un esecutore: un tipo che dichiara is_executor e fornisce
+ * - concurrency(): numero di compiti che possono essere eseguiti contemporaneamente;
+ * - threshold(): numero minimo di elementi per compito, sotto il quale conviene
+ *   l'esecuzione sequenziale;
+ * - bulk(n, f): esegue f(0), ..., f(n - 1), anche in parallelo, e ritorna quando sono
+ *   tutti terminati, rilanciando la prima eccezione sollevata.
+ * Qualsiasi tipo con queste caratteristiche può essere passato a SortedArray al posto di ThreadPool,
+ * ad esempio per riutilizzare i thread di un'altra libreria.
+ *
+ * In bulk() gli indici vengono distribuiti uno alla volta, con un contatore atomico, ai thread
+ * del pool e al thread chiamante, che partecipa all'esecuzione: un thread che termina prima
+ * prende l'indice successivo, per cui compiti di durata diversa restano bilanciati.
+ * bulk() non deve essere chiamato da un compito dello stesso pool.
+ */
+class ThreadPool{
+
+    public:
+
+    typedef void is_executor;
+
+    static const std::size_t DEFAULT_THRESHOLD = 1 << 15;
+
+    /**
+     * @brief Crea il pool. Il thread chiamante di bulk() partecipa ai compiti,
+     * per cui vengono avviati threads - 1 thread.
+     *
+     * @param threads numero di compiti contemporanei, 0 per il numero di core
+     * @param threshold numero minimo di elementi per compito, almeno 1
+     */
+    explicit ThreadPool(std::size_t threads = 0, std::size_t threshold = DEFAULT_THRESHOLD)
+        : _threshold(threshold > 0 ? threshold : 1), _stop(false) {
+        if(threads == 0){
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        try{
+            for(std::size_t i = 1; i < threads; ++i){
+                _workers.emplace_back([this]{ work(); });
+            }
+        } catch(...){
+            stop();
+            throw;
+        }
+    }
+
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool& operator=(const ThreadPool &other) = delete;
+
+    /**
+     * @brief Distruttore: attende la fine dei compiti in corso e termina i thread.
+     *
+     */
+    ~ThreadPool(){
+        stop();
+    }
+
+    /**
+     * @brief Numero di compiti eseguiti contemporaneamente, compreso il thread chiamante.
+     *
+     * @return std::size_t numero di thread
+     */
+    std::size_t concurrency() const {
+        return _workers.size() + 1;
+    }
+
+    /**
+     * @brief Numero minimo di elementi per compito: le sequenze più corte del doppio
+     * vengono ordinate senza usare il pool.
+     *
+     * @return std::size_t soglia
+     */
+    std::size_t threshold() const {
+        return _threshold;
+    }
+
+    /**
+     * @brief Imposta la soglia dell'esecuzione parallela.
+     *
+     * @param threshold numero minimo di elementi per compito, almeno 1
+     */
+    void setThreshold(std::size_t threshold){
+        _threshold = threshold > 0 ? threshold : 1;
+    }
+
+    /**
+     * @brief Esegue f(i) per ogni i in [0, n) e attende che tutti i compiti siano terminati.
+     * Se uno o più compiti sollevano un'eccezione, gli altri vengono comunque eseguiti
+     * e la prima eccezione viene rilanciata.
+     *
+     * @tparam F tipo della funzione, chiamata con un std::size_t
+     * @param n numero di compiti
+     * @param f funzione da eseguire
+     */
+    template<typename F>
+    void bulk(std::size_t n, F f){
+        job state(n);
+        std::function<void(std::size_t)> task(std::ref(f));
+        state.task = &task;
+
+        std::size_t helpers = std::min(n, _workers.size() + 1) - (n > 0);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for(std::size_t i = 0; i < helpers; ++i){
+                _queue.push_back(&state);
+            }
+        }
+        _ready.notify_all();
+
+        state.run();
+
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.finished.wait(lock, [&]{ return state.helpersDone == helpers; });
+        if(state.error){
+            std::rethrow_exception(state.error);
+        }
+    }
+
+    private:
+
+    /**
+     * @brief Stato di una chiamata di bulk(), condiviso dai thread che la eseguono.
+     *
+     */
+    struct job{
+
+        explicit job(std::size_t count): next(0), n(count), task(nullptr), helpersDone(0) {}
+
+        /**
+         * @brief Esegue compiti finché ne rimangono, registrando la prima eccezione.
+         *
+         */
+        void run(){
+            for(std::size_t i = next++; i < n; i = next++){
+                try{
+                    (*task)(i);
+                } catch(...){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(!error){
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        std::atomic<std::size_t> next;
+        std::size_t n;
+        std::function<void(std::size_t)> *task;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::size_t helpersDone;
+        std::exception_ptr error;
+    };
+
+    /**
+     * @brief Ciclo dei thread del pool: attende una chiamata di bulk() e vi partecipa.
+     *
+     */
+    void work(){
+        for(;;){
+            job *state;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _ready.wait(lock, [this]{ return _stop || !_queue.empty(); });
+                if(_queue.empty()){
+                    return;
+                }
+                state = _queue.front();
+                _queue.pop_front();
+            }
+            state->run();
+            // la notifica avviene con il mutex acquisito: bulk() non può ritornare,
+            // distruggendo lo stato, prima che sia terminata
+            std::lock_guard<std::mutex> lock(state->mutex);
+            ++state->helpersDone;
+            state->finished.notify_one();
+        }
+    }
+
+    /**
+     * @brief Termina i thread del pool dopo che hanno esaurito la coda.
+     *
+     */
+    void stop(){
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _ready.notify_all();
+        for(std::thread &t : _workers){
+            t.join();
+        }
+        _workers.clear();
+    }
+
+    std::vector<std::thread> _workers;
+    std::deque<job*> _queue;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::size_t _threshold;
+    bool _stop;
+
+};
+
+#endif
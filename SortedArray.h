@@ -2,6 +2,16 @@
 #define SortedArray_H
 #include <iostream>
 #include <cassert>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "SortedArrayStats.h"
+#include "SortedArraySimd.h"
 
 /**
  * @brief Classe array dinamico ordinato
@@ -9,43 +19,268 @@
  * La classe implementa un'array dinamico ordinato e generico di oggetti T.
  * Gli oggetti dell'array sono ordinati con l'utilizzo del funtore C,
  * che prende due valori a e b e ritorna true se i valori sono nell'ordine corretto,
- * unito all'algoritmo di ordinamento insertion sort, efficiente per l'ordinamento di 
- * strutture dati già parzialmente ordinate.
+ * unito ad un merge sort naturale adattivo (sul modello di Timsort), lineare sulle
+ * strutture dati già ordinate ed O(n log n) nel caso peggiore.
  * 
+ * La capacità dell'array è separata dal numero di elementi: con la politica GEOMETRIC
+ * (default) la capacità raddoppia quando l'array è pieno, rendendo ammortizzato il costo
+ * di allocazione di push(); con la politica MINIMAL l'array mantiene tante celle di memoria
+ * quanti sono i suoi elementi.
+ * 
+ * La memoria è gestita come spazio non inizializzato tramite l'allocatore Alloc e
+ * std::allocator_traits: solo le celle che contengono un elemento sono costruite, per cui
+ * T non deve avere un costruttore di default. Se T è banalmente copiabile, gli spostamenti
+ * degli elementi vengono eseguiti con memmove; altrimenti il suo costruttore di spostamento
+ * (o di copia, in sua assenza) deve essere noexcept, così che gli spostamenti interni
+ * (inserimento, rimozione, compattazione, ordinamento) non possano lasciare celle distrutte
+ * a metà operazione.
+ * 
+ * Se T è un tipo aritmetico e il funtore equivale a < o > (vedi comparator_traits), le ricerche
+ * usano i kernel vettoriali di SortedArraySimd.h, che non chiamano il funtore; anche filter()
+ * compatta gli elementi aritmetici con quei kernel, valutando però il predicato un elemento alla volta.
+ * 
+ * Definendo la macro SORTEDARRAY_STATS l'array conta confronti, copie, spostamenti e
+ * allocazioni e misura il tempo delle operazioni (vedi stats()).
  * 
  * @tparam T Tipo di dato all'interno dell'arrray
  * @tparam C Funtore di ordinamento
+ * @tparam Alloc Allocatore degli elementi, ad esempio std::pmr::polymorphic_allocator<T>
+ * o uno degli allocatori di Allocators.h
+ */
+
+/**
+ * @brief Indica se un array ordinato con il funtore B è già ordinato anche secondo il funtore C.
+ * In questo caso il costruttore secondario di SortedArray copia gli elementi senza riordinarli.
+ * Di default vale solo per funtori dello stesso tipo (senza stato o con lo stesso stato);
+ * può essere specializzato per coppie di funtori diversi che inducono lo stesso ordinamento.
+ * 
+ * @tparam B funtore dell'array di origine
+ * @tparam C funtore dell'array di destinazione
+ */
+template<typename B, typename C>
+struct order_compatible : std::is_same<B, C> {};
+
+/**
+ * @brief Politica di crescita della capacità dei contenitori ordinati (SortedArray, SortedMap).
+ * GEOMETRIC raddoppia la capacità quando il contenitore è pieno,
+ * MINIMAL mantiene la capacità uguale al numero di elementi.
+ */
+struct sorted_growth {
+
+    enum growth_policy { GEOMETRIC, MINIMAL };
+
+    /**
+     * @brief Capacità con cui far crescere un contenitore pieno secondo la politica data.
+     * 
+     * @param policy politica di crescita
+     * @param capacity capacità attuale
+     * @param minCapacity capacità minima richiesta
+     * @return int nuova capacità, non inferiore a minCapacity
+     */
+    static int grownCapacity(growth_policy policy, int capacity, int minCapacity){
+        if(policy == GEOMETRIC && capacity * 2 > minCapacity){
+            return capacity * 2;
+        }
+        return minCapacity;
+    }
+
+};
+
+/**
+ * @brief Gestione dello spazio non inizializzato dei contenitori ordinati tramite l'allocatore
+ * Alloc e std::allocator_traits, condivisa da SortedArray e SortedMap. Le funzioni non raccolgono
+ * statistiche: se ne occupano i contenitori che le chiamano.
+ * 
+ * @tparam Alloc allocatore degli elementi
  */
+template<typename Alloc>
+struct sorted_storage {
+
+    typedef std::allocator_traits<Alloc> alloc_traits;
+    typedef typename alloc_traits::value_type value_type;
+    typedef int size_type;
+
+    /**
+     * @brief Alloca spazio non inizializzato per n elementi.
+     * 
+     * @param alloc allocatore
+     * @param n numero di elementi
+     * @return value_type* puntatore allo spazio allocato, nullptr se n è 0
+     */
+    static value_type* allocate(Alloc &alloc, size_type n){
+        return n > 0 ? alloc_traits::allocate(alloc, n) : nullptr;
+    }
+
+    /**
+     * @brief Rilascia lo spazio allocato con allocate(alloc, n).
+     * 
+     * @param alloc allocatore
+     * @param p puntatore allo spazio, può essere nullptr
+     * @param n numero di elementi passato ad allocate()
+     */
+    static void deallocate(Alloc &alloc, value_type *p, size_type n){
+        if(p != nullptr){
+            alloc_traits::deallocate(alloc, p, n);
+        }
+    }
+
+    /**
+     * @brief Distrugge gli elementi nell'intervallo [first, last).
+     * 
+     * @param alloc allocatore
+     * @param first primo elemento
+     * @param last elemento successivo all'ultimo
+     */
+    static void destroy(Alloc &alloc, value_type *first, value_type *last){
+        if(!std::is_trivially_destructible<value_type>::value){
+            for(; first != last; ++first){
+                alloc_traits::destroy(alloc, first);
+            }
+        }
+    }
+
+    /**
+     * @brief Costruisce in dst una copia degli elementi di [first, last).
+     * Se una costruzione fallisce, gli elementi già costruiti vengono distrutti.
+     * 
+     * @tparam Iter tipo degli iteratori
+     * @param alloc allocatore
+     * @param first inizio della sequenza
+     * @param last fine della sequenza
+     * @param dst spazio non inizializzato di destinazione
+     * @return value_type* posizione successiva all'ultimo elemento costruito
+     */
+    template<typename Iter>
+    static value_type* constructFrom(Alloc &alloc, Iter first, Iter last, value_type *dst){
+        value_type *cur = dst;
+        try{
+            for(; first != last; ++first, ++cur){
+                alloc_traits::construct(alloc, cur, *first);
+            }
+        } catch(...){
+            destroy(alloc, dst, cur);
+            throw;
+        }
+        return cur;
+    }
+
+    /**
+     * @brief Sposta n elementi da src a dst, distruggendo gli originali: le celle di src
+     * non sovrapposte a dst rimangono non inizializzate, quelle di dst devono esserlo.
+     * Gli intervalli possono sovrapporsi. Se value_type è banalmente copiabile esegue una sola memmove.
+     * Non lancia eccezioni: i contenitori richiedono un costruttore di spostamento noexcept.
+     * 
+     * @param alloc allocatore
+     * @param src primo elemento da spostare
+     * @param n numero di elementi
+     * @param dst destinazione del primo elemento
+     */
+    static void relocate(Alloc &alloc, value_type *src, size_type n, value_type *dst) noexcept {
+        if(n == 0 || src == dst){
+            return;
+        }
+        if(std::is_trivially_copyable<value_type>::value){
+            std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+        } else if(dst < src){
+            for(size_type i = 0; i < n; ++i){
+                alloc_traits::construct(alloc, dst + i, std::move(src[i]));
+                alloc_traits::destroy(alloc, src + i);
+            }
+        } else {
+            for(size_type i = n; i > 0; --i){
+                alloc_traits::construct(alloc, dst + i - 1, std::move(src[i - 1]));
+                alloc_traits::destroy(alloc, src + i - 1);
+            }
+        }
+    }
+
+    /**
+     * @brief Scambia due allocatori insieme ai buffer che hanno allocato, indipendentemente dalla
+     * politica di propagazione. Gli allocatori non assegnabili (come std::pmr::polymorphic_allocator)
+     * devono essere uguali.
+     * 
+     * @param a primo allocatore
+     * @param b secondo allocatore
+     */
+    static void swapAllocators(Alloc &a, Alloc &b) noexcept {
+        if constexpr(std::is_swappable<Alloc>::value){
+            std::swap(a, b);
+        } else {
+            assert(a == b);
+        }
+    }
+
+    /**
+     * @brief Scambia due allocatori solo se l'allocatore lo prevede (propagate_on_container_swap),
+     * altrimenti devono essere uguali.
+     * 
+     * @param a primo allocatore
+     * @param b secondo allocatore
+     */
+    static void propagateSwap(Alloc &a, Alloc &b) noexcept {
+        assert(alloc_traits::propagate_on_container_swap::value || a == b);
+        if constexpr(alloc_traits::propagate_on_container_swap::value){
+            std::swap(a, b);
+        }
+    }
+
+};
 
-template<typename T, typename C>
-class SortedArray{
+template<typename T, typename C, typename Alloc = std::allocator<T> >
+class SortedArray : public sorted_growth {
+
+    static_assert(std::is_trivially_copyable<T>::value || std::is_nothrow_move_constructible<T>::value,
+        "SortedArray richiede un tipo banalmente copiabile o con costruttore di spostamento noexcept");
+
+    typedef std::allocator_traits<Alloc> alloc_traits;
+    typedef sorted_storage<Alloc> storage;
+    typedef sorted_array_simd<T, (comparator_traits<C>::order < 0)> simd_kernels;
+
+    /**
+     * @brief Vale true se la ricerca di una chiave di tipo K può usare simd_kernels.
+     * 
+     */
+    template<typename K>
+    struct simd_search : std::integral_constant<bool, has_simd_order<T, C>::value && std::is_same<K, T>::value> {};
 
     public:
 
     typedef int size_type;
     typedef T value_type;
     typedef C comparison;
+    typedef Alloc allocator_type;
 
     /**
      * @brief Costruttore di default:
      * Crea un SortedArray vuoto di dimensione 0, da riempire attraverso la funzione push().
      * 
+     * @param policy politica di crescita della capacità
+     * @param alloc allocatore da utilizzare
      */
-    SortedArray(){
-        _array = new value_type[0];
+    SortedArray(growth_policy policy = GEOMETRIC, const allocator_type &alloc = allocator_type()): _alloc(alloc){
+        _array = nullptr;
         _size = 0;
+        _capacity = 0;
+        _policy = policy;
 
     };
 
+    /**
+     * @brief Crea un SortedArray vuoto che utilizza l'allocatore dato.
+     * 
+     * @param alloc allocatore da utilizzare
+     */
+    explicit SortedArray(const allocator_type &alloc): SortedArray(GEOMETRIC, alloc){
+
+    }
+
     /**
      * @brief Distruttore 
      * 
      */
     ~SortedArray(){
 
-        delete[] _array;
-        _array = nullptr;
-        _size = 0;
+        release();
     }
 
     /**
@@ -53,56 +288,92 @@ class SortedArray{
      * 
      * @param other SortedArray da copiare
      */
-    SortedArray(const SortedArray &other): _array(nullptr), _size(0) {
+    SortedArray(const SortedArray &other)
+        : SortedArray(other, alloc_traits::select_on_container_copy_construction(other._alloc)) {
 
-        try{
-            _size = other.size();
-            _array = new value_type[_size];
-            for(int i = 0; i < _size; ++i){
-                _array[i] = other._array[i];
-            }
+    }
+
+    /**
+     * @brief Copy constructor con allocatore esplicito
+     * 
+     * @param other SortedArray da copiare
+     * @param alloc allocatore da utilizzare per la copia
+     */
+    SortedArray(const SortedArray &other, const allocator_type &alloc)
+        : _array(nullptr), _size(0), _capacity(0), _policy(other._policy), _cmp(other._cmp), _alloc(alloc) {
 
+        _array = allocate(other._size);
+        try{
+            constructFrom(other._array, other._array + other._size, _array);
         } catch(...){
-            delete[] _array;
+            deallocate(_array, other._size);
             _array = nullptr;
             throw;
         }
+        _size = other._size;
+        _capacity = _size;
 
     }
 
     /**
      * @brief Costruttore secondario che crea un SortedArray
      * riempito con gli elementi di un altro SortedArray generico.
+     * Non viene usato per le copie di SortedArray dello stesso tipo, gestite dal copy constructor.
+     * Se order_compatible<B, C> è vera gli elementi mantengono l'ordine di other e non vengono
+     * riordinati: la costruzione esegue solo le n copie, senza confronti.
      * 
      * @tparam A tipo del SortedArray da copiare   
      * @tparam B funtore di ordinamento del SortedArray da copiare
+     * @tparam AA allocatore del SortedArray da copiare
      * @param other 
+     * @param alloc allocatore da utilizzare
      */
-    template<typename A, typename B>
-    explicit SortedArray(SortedArray<A, B> &other){
-        typename SortedArray<A, B>::iterator it,ite;
+    template<typename A, typename B, typename AA,
+             typename = typename std::enable_if<!std::is_same<SortedArray<A, B, AA>, SortedArray>::value>::type>
+    explicit SortedArray(SortedArray<A, B, AA> &other, const allocator_type &alloc = allocator_type()): _policy(GEOMETRIC), _alloc(alloc){
+        typename SortedArray<A, B, AA>::iterator it,ite;
         it = other.begin();
         ite = other.end();
         assert(ite > it);
-        _size = ite - it;
+        _size = 0;
+        _capacity = ite - it;
+        _array = allocate(_capacity);
             try{
-                _array = new value_type[_size];
-                unsigned int i = 0;
                 for(; it != ite; ++it){
-                    _array[i] = static_cast<value_type>(*it);
-                    ++i;
+                    alloc_traits::construct(_alloc, _array + _size, static_cast<value_type>(*it));
+                    SORTEDARRAY_COUNT(copies, 1);
+                    ++_size;
+                }
+                if constexpr(!order_compatible<B, C>::value){
+                    sort();
                 }
-                sort();
             } catch(...){
-                delete[] _array;
-                _array = nullptr;
-                _size = 0;
+                release();
                 throw;
             }
     }
 
+    /**
+     * @brief Move constructor: acquisisce il buffer di other senza copiarne gli elementi.
+     * other rimane un SortedArray vuoto e valido.
+     * 
+     * @param other SortedArray da spostare
+     */
+    SortedArray(SortedArray &&other) noexcept
+        : _array(other._array), _size(other._size), _capacity(other._capacity),
+          _policy(other._policy), _cmp(std::move(other._cmp)), _alloc(std::move(other._alloc)) {
+
+        other._array = nullptr;
+        other._size = 0;
+        other._capacity = 0;
+        ++other._version;
+    }
+
     /**
      * @brief Operatore assegnamento
+     * La copia viene costruita prima di modificare this, che rimane invariato
+     * se la copia fallisce. L'allocatore di other viene adottato solo se
+     * l'allocatore lo prevede (propagate_on_container_copy_assignment).
      * 
      * @param other SortedArray da copiare
      * @return SortedArray& reference all'array this
@@ -110,21 +381,90 @@ class SortedArray{
     SortedArray& operator=(const SortedArray &other){
 
         if(this != &other){
-            SortedArray tmp(other);
-            this->toEmpty();
-            try{
-                for(int i = 0; i < tmp.size(); ++i){
-                    this->push(tmp._array[i]);
-                } 
-            } catch(...){
-                delete[] _array;
-                _array = nullptr;
-                throw;
+            SortedArray tmp(other, alloc_traits::propagate_on_container_copy_assignment::value ? other._alloc : _alloc);
+            swapStorage(tmp);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Operatore assegnamento per spostamento
+     * Il buffer di other viene acquisito se gli allocatori sono intercambiabili, altrimenti
+     * gli elementi vengono spostati uno ad uno nella memoria di this.
+     * 
+     * @param other SortedArray da spostare, che rimane vuoto
+     * @return SortedArray& reference all'array this
+     */
+    SortedArray& operator=(SortedArray &&other)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+
+        if(this != &other){
+            if(alloc_traits::propagate_on_container_move_assignment::value || _alloc == other._alloc){
+                release();
+                if constexpr(alloc_traits::propagate_on_container_move_assignment::value){
+                    _alloc = std::move(other._alloc);
+                }
+                _array = other._array;
+                _size = other._size;
+                _capacity = other._capacity;
+                _policy = other._policy;
+                _cmp = std::move(other._cmp);
+
+                other._array = nullptr;
+                other._size = 0;
+                other._capacity = 0;
+                ++other._version;
+            } else {
+                SortedArray tmp(_policy, _alloc);
+                tmp.reserve(other._size);
+                for(size_type i = 0; i < other._size; ++i){
+                    tmp.append(std::move(other._array[i]));
+                }
+                tmp._policy = other._policy;
+                tmp._cmp = std::move(other._cmp);
+                swapStorage(tmp);
+                other.release();
             }
         }
         return *this;
     }
 
+    /**
+     * @brief Scambia il contenuto di this con quello di other in tempo costante.
+     * Gli allocatori vengono scambiati solo se l'allocatore lo prevede
+     * (propagate_on_container_swap), altrimenti devono essere uguali.
+     * 
+     * @param other SortedArray da scambiare
+     */
+    void swap(SortedArray &other) noexcept {
+        storage::propagateSwap(_alloc, other._alloc);
+        ++_version;
+        ++other._version;
+        std::swap(_array, other._array);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_policy, other._policy);
+        std::swap(_cmp, other._cmp);
+    }
+
+    /**
+     * @brief Getter del funtore di ordinamento
+     * 
+     * @return comparison copia del funtore usato dall'array
+     */
+    comparison value_comp() const {
+        return _cmp;
+    }
+
+    /**
+     * @brief Getter dell'allocatore
+     * 
+     * @return allocator_type copia dell'allocatore utilizzato
+     */
+    allocator_type get_allocator() const {
+        return _alloc;
+    }
+
     /**
      * @brief Costruttore secondario che crea un SortedArray riempito con dati
      * presi da una sequenza di identificata da un iteratore di inizio ed uno di fine.
@@ -133,143 +473,368 @@ class SortedArray{
      * @tparam Iter tipo degli iteratori.
      * @param it iteratore di inizio.
      * @param ite iteratore di fine.
+     * @param alloc allocatore da utilizzare
      */
     template <typename Iter> 
-    explicit SortedArray(Iter it, Iter ite){
+    explicit SortedArray(Iter it, Iter ite, const allocator_type &alloc = allocator_type()): _policy(GEOMETRIC), _alloc(alloc){
         assert(it < ite);
-        _size = ite - it;
+        _size = 0;
+        _capacity = ite - it;
+        _array = allocate(_capacity);
         try{
-            _array = new value_type[_size];
-            unsigned int i = 0;
-            for(; it != ite; ++it){
-                _array[i] = *it;
-                ++i;
-            }
+            constructFrom(it, ite, _array);
+            _size = _capacity;
 
             sort();
 
         } catch(...){
-            delete[] _array;
-            _array = nullptr;
+            release();
             throw;
         }   
     }
+
+    /**
+     * @brief Come il costruttore da una sequenza, ma gli elementi vengono ordinati in parallelo
+     * con sort(Executor &), usando l'esecutore dato (ad esempio un ThreadPool di ParallelBuild.h).
+     * 
+     * @tparam Iter tipo degli iteratori
+     * @tparam Executor tipo dell'esecutore
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     * @param executor esecutore dei compiti paralleli
+     * @param alloc allocatore da utilizzare
+     */
+    template<typename Iter, typename Executor, typename = typename Executor::is_executor>
+    SortedArray(Iter first, Iter last, Executor &executor, const allocator_type &alloc = allocator_type()): _policy(GEOMETRIC), _alloc(alloc){
+        _size = 0;
+        _capacity = std::distance(first, last);
+        _array = allocate(_capacity);
+        try{
+            constructFrom(first, last, _array);
+            _size = _capacity;
+        } catch(...){
+            release();
+            throw;
+        }
+        sort(executor);
+    }
     
     /**
-     * @brief Aumenta la capacità dell'array, aggiunge l'elemento dato in input
-     * ed infine chiama l'algoritmo di ordinamento sort(), mantenendo l'ordinamento indotto
-     * dal funtore di tipo C.
+     * @brief Aggiunge una copia dell'elemento dato in input, aumentando la capacità dell'array
+     * solo se è pieno. La posizione di inserimento è trovata con una ricerca binaria
+     * guidata dal funtore di tipo C: l'elemento viene inserito dopo quelli equivalenti,
+     * spostando di una posizione solo gli elementi successivi.
      * 
      * @param element elemento da aggiungere all'array.
      */
-    void push(const value_type element){
+    void push(const value_type &element){
+        SORTEDARRAY_COUNT(copies, 1);
+        insertSorted(value_type(element));
+    }
+
+    /**
+     * @brief Come push(const value_type &), ma l'elemento viene spostato nell'array invece che copiato.
+     * 
+     * @param element elemento da aggiungere all'array.
+     */
+    void push(value_type &&element){
+        insertSorted(std::move(element));
+    }
+
+    /**
+     * @brief Inserisce gli elementi della sequenza [first, last).
+     * Gli elementi vengono copiati in un buffer temporaneo, ordinati in O(k log k) e fusi
+     * con l'array in un solo passaggio lineare, procedendo dal fondo. Se la sequenza segue
+     * interamente l'ultimo elemento viene semplicemente accodata; se è piccola rispetto
+     * all'array, la posizione di ogni elemento viene trovata con una ricerca binaria e gli
+     * elementi intermedi vengono spostati a blocchi (galloping).
+     * Gli elementi equivalenti già presenti precedono quelli inseriti.
+     * 
+     * @tparam Iter tipo degli iteratori.
+     * @param first iteratore di inizio.
+     * @param last iteratore di fine.
+     */
+    template <typename Iter>
+    void insert(Iter first, Iter last){
+        SORTEDARRAY_TIME(INSERT);
+        size_type k = std::distance(first, last);
+        if(k == 0){
+            return;
+        }
+
+        value_type *batch = allocate(k);
+        try{
+            constructFrom(first, last, batch);
+        } catch(...){
+            deallocate(batch, k);
+            throw;
+        }
+
         try{
-            value_type* tmp = new value_type[_size + 1];
-            for ( int i = 0; i < _size; ++i){
-                tmp[i] = _array[i];
+            std::stable_sort(batch, batch + k, [this](const value_type &a, const value_type &b){ return compare(a, b); });
+
+            if(_size + k > _capacity){
+                grow(_size + k);
             }
 
-            tmp[_size] = element;
-            ++_size;
+            if(_size == 0 || !compare(batch[0], _array[_size - 1])){
+                for(size_type j = 0; j < k; ++j){
+                    alloc_traits::construct(_alloc, _array + _size + j, std::move(batch[j]));
+                }
+                SORTEDARRAY_COUNT(moves, k);
+            } else {
+                mergeBack(batch, k);
+            }
+            _size += k;
+            ++_version;
+
+        } catch(...){
+            destroy(batch, batch + k);
+            deallocate(batch, k);
+            throw;
+        }
+        destroy(batch, batch + k);
+        deallocate(batch, k);
+    }
 
-            delete[] _array;
-            _array = tmp;
+    /**
+     * @brief Come insert(first, last), ma gli elementi inseriti vengono ordinati in parallelo
+     * e fusi con quelli dell'array come in sort(Executor &); gli elementi equivalenti
+     * già presenti precedono quelli inseriti.
+     * Se la sequenza è più corta del doppio di executor.threshold() viene usato insert(first, last).
+     * 
+     * @tparam Iter tipo degli iteratori
+     * @tparam Executor tipo dell'esecutore
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     * @param executor esecutore dei compiti paralleli
+     */
+    template<typename Iter, typename Executor, typename = typename Executor::is_executor>
+    void insert(Iter first, Iter last, Executor &executor){
+        size_type k = std::distance(first, last);
+        if(!parallel(executor, k)){
+            insert(first, last);
+            return;
+        }
+        SORTEDARRAY_TIME(INSERT);
+        if(_size + k > _capacity){
+            grow(_size + k);
+        }
+        constructFrom(first, last, _array + _size);
+        size_type sorted = _size;
+        _size += k;
+        parallelSort(executor, sorted);
+    }
 
-            sort();
-        
-        } catch(...) {
-                throw;
+    /**
+     * @brief Accoda gli elementi di [first, last) senza ordinarli e senza confrontarli:
+     * la sequenza deve essere già ordinata secondo C e il suo primo elemento non deve precedere
+     * l'ultimo elemento dell'array. Serve a ricostruire in tempo lineare un array salvato.
+     * 
+     * @tparam Iter tipo degli iteratori
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     */
+    template <typename Iter>
+    void append_sorted(Iter first, Iter last){
+        size_type k = std::distance(first, last);
+        if(k == 0){
+            return;
+        }
+        if(_size + k > _capacity){
+            grow(_size + k);
         }
+        constructFrom(first, last, _array + _size);
+        _size += k;
+        ++_version;
+    }
+
+    /**
+     * @brief Come append_sorted(), ma i k elementi vengono scritti da fill direttamente nella
+     * memoria dell'array, senza un buffer intermedio: fill riceve un puntatore a k celle non
+     * inizializzate e ritorna true se le ha riempite tutte (ad esempio leggendole da un file).
+     * Richiede T banalmente copiabile. Se fill ritorna false o lancia un'eccezione gli elementi
+     * dell'array non cambiano; la capacità può essere aumentata.
+     * 
+     * @tparam Fill funtore chiamato con (value_type *)
+     * @param k numero di elementi da accodare
+     * @param fill funtore che scrive gli elementi
+     * @return true se gli elementi sono stati accodati
+     */
+    template <typename Fill>
+    bool append_sorted_raw(size_type k, Fill fill){
+        static_assert(std::is_trivially_copyable<value_type>::value, "append_sorted_raw richiede un tipo banalmente copiabile");
+        if(k == 0){
+            return true;
+        }
+        if(_size + k > _capacity){
+            grow(_size + k);
+        }
+        if(!fill(_array + _size)){
+            return false;
+        }
+        SORTEDARRAY_COUNT(copies, k);
+        _size += k;
+        ++_version;
+        return true;
+    }
 
+    /**
+     * @brief Inserisce tutti gli elementi della lista, con le stesse modalità di insert().
+     * 
+     * @param elements elementi da aggiungere all'array.
+     */
+    void push_many(std::initializer_list<value_type> elements){
+        insert(elements.begin(), elements.end());
+    }
 
+    /**
+     * @brief Porta la capacità dell'array ad almeno n elementi.
+     * Se la capacità attuale è già sufficiente non fa nulla.
+     * 
+     * @param n capacità minima richiesta
+     */
+    void reserve(size_type n){
+        if(n > _capacity){
+            reallocate(n);
+        }
+    }
 
+    /**
+     * @brief Riduce la capacità dell'array al numero di elementi contenuti.
+     * 
+     */
+    void shrink_to_fit(){
+        if(_capacity > _size){
+            reallocate(_size);
+        }
     }
 
     /**
      * @brief 
-     * Ordina gli elementi del SortedArray attraverso l'algoritmo insertion sort unito al funtore fornito dall'utente.
-     * L'algoritmo di Insertion Sort ordina l'array progressivamente, inserendo ogni elemento
-     * nella posizione corretta all'interno della parte ordinata dell'array.
+     * Ordina gli elementi del SortedArray con un merge sort naturale stabile unito al funtore fornito dall'utente.
+     * L'array viene diviso nelle sequenze già ordinate che contiene (quelle strettamente decrescenti
+     * vengono invertite); le sequenze più corte di una soglia minima vengono estese con un insertion sort
+     * binario e poi fuse a coppie mantenendo bilanciate le loro lunghezze, come in Timsort.
+     * Su un array già ordinato esegue un solo passaggio lineare.
      */
     void sort(){
+        SORTEDARRAY_TIME(SORT);
+        ++_version;
+        if(_size < 2){
+            return;
+        }
+
+        value_type *buffer = nullptr;
         try {
-            for (unsigned int i = 1; i < _size; ++i) {
-                value_type aux = _array[i];
-                int j = i - 1;
-                while (j >= 0 && _cmp(aux, _array[j])) {
-                    _array[j + 1] = _array[j];
-                    --j;
+            run_stack runs;
+            runs.size = 0;
+            size_type minRun = minRunLength(_size);
+            size_type lo = 0;
+
+            while(lo < _size){
+                size_type length = countRun(lo);
+                if(length < minRun){
+                    size_type forced = std::min(minRun, _size - lo);
+                    binaryInsertionSort(lo, lo + forced, lo + length);
+                    length = forced;
                 }
-                _array[j + 1] = aux;
+
+                runs.start[runs.size] = lo;
+                runs.length[runs.size] = length;
+                ++runs.size;
+                lo += length;
+
+                while(runs.size > 1){
+                    int n = runs.size - 2;
+                    if((n > 0 && runs.length[n - 1] <= runs.length[n] + runs.length[n + 1]) ||
+                       (n > 1 && runs.length[n - 2] <= runs.length[n - 1] + runs.length[n])){
+                        if(runs.length[n - 1] < runs.length[n + 1]){
+                            --n;
+                        }
+                    } else if(runs.length[n] > runs.length[n + 1]){
+                        break;
+                    }
+                    mergeAt(runs, n, buffer);
+                }
+            }
+
+            while(runs.size > 1){
+                int n = runs.size - 2;
+                if(n > 0 && runs.length[n - 1] < runs.length[n + 1]){
+                    --n;
+                }
+                mergeAt(runs, n, buffer);
             }
         } catch (...) {
-            delete[] _array;
-            _array = nullptr;
-            _size = 0;
+            deallocate(buffer, _size / 2 + 1);
+            release();
             throw;
         }
+        deallocate(buffer, _size / 2 + 1);
     }
 
     /**
-     * @brief Ritorna true se l'oggetto element è presente nell'array
+     * @brief Ordina gli elementi in parallelo con l'esecutore dato: l'array viene diviso
+     * in executor.concurrency() parti, ordinate contemporaneamente con std::stable_sort,
+     * e le parti vengono poi fuse in un nuovo buffer con una fusione a più vie, anch'essa
+     * divisa in compiti indipendenti. I confini di ogni compito della fusione sono calcolati
+     * cercando, in tutte le parti, l'elemento di rango dato; a parità di elemento precede quello
+     * della parte precedente, per cui l'ordinamento è stabile come sort().
+     * 
+     * Se l'array ha meno di 2 * executor.threshold() elementi, se l'esecutore ha un solo thread
+     * o se lo spostamento di T può sollevare eccezioni viene usato sort(). Il funtore deve poter
+     * essere chiamato contemporaneamente da più thread; i confronti eseguiti dai compiti
+     * paralleli non vengono contati in stats(). Se un confronto solleva un'eccezione l'array
+     * viene svuotato, come in sort().
+     * 
+     * @tparam Executor tipo dell'esecutore (vedi ThreadPool in ParallelBuild.h)
+     * @param executor esecutore dei compiti paralleli
+     */
+    template<typename Executor, typename = typename Executor::is_executor>
+    void sort(Executor &executor){
+        if(!parallel(executor, _size)){
+            sort();
+            return;
+        }
+        SORTEDARRAY_TIME(SORT);
+        parallelSort(executor, 0);
+    }
+
+    /**
+     * @brief Ritorna true se l'oggetto element è presente nell'array.
+     * La ricerca binaria individua gli elementi equivalenti ad element secondo il funtore,
+     * tra i quali viene cercato quello uguale secondo l'operatore ==.
      * 
      * @param element Oggetto di cui verificare la presenza
      * @return true 
      * @return false 
      */
 
-    bool encountered(const value_type element) const {
+    bool encountered(const value_type &element) const {
 
-        for(int i = 0; i < _size ; ++i)
-            if(_array[i] == element){
-                return true;
-            }
-
-        return false;      
+        return indexOf(element) != _size;
 
     }
 
     /**
      * @brief Rimuove un elemento di tipo T dell'array. 
      * Se più elementi sono rimuovibili, elimina il primo.
+     * L'elemento è individuato con una ricerca binaria e gli elementi successivi
+     * vengono spostati indietro di una posizione, senza riallocare l'array.
      * 
      * @param element Elemento da rimuovere
+     * @return true se l'elemento era presente ed è stato rimosso
+     * @return false
      */
-    void remove(const value_type element){
-
-        bool encountered = false;
+    bool remove(const value_type &element){
 
-        for(int i = 0; i < _size ; ++i)
-            if(_array[i] == element){
-                encountered = true;
-            }
+        size_type index = indexOf(element);
         
-        if(encountered){
-            unsigned int slot = 0;
-            encountered = false;
-
-            try{
-                value_type* tmp = new value_type[_size-1];
-
-                for(int i = 0; i < _size; ++i){
-
-                    if(_array[i] == element && !encountered){
-                        encountered = true;
-                    } else {
-                        tmp[slot] = _array[i];
-                        ++slot;
-                    }
-
-                }
-
-                delete[] _array;
-                _array = tmp;
-                --_size;
-
-            }catch(...) {
-                throw;
-            }
-        } else return;
+        if(index != _size){
+            erase(iterator(_array + index));
+            return true;
+        } else return false;
 
     }
 
@@ -278,28 +843,79 @@ class SortedArray{
      * 
      */
     void toEmpty(){
-        value_type *tmp = new value_type[0];
-        delete[] _array;
-        _size = 0;
-        _array = tmp;
+        release();
     }
 
     /**
-     * @brief Getter della capienza dell'array
+     * @brief Getter del numero di elementi dell'array
      * 
-     * @return size_type Capienza dell'array
+     * @return size_type Numero di elementi dell'array
      */
     size_type size() const{
         return _size;
     }
 
     /**
-     * @brief Iteratore di tipo random access che itera gli elementi dell'array in ordine.
+     * @brief Puntatore al primo elemento, in sola lettura: gli elementi sono contigui
+     * e ordinati, e il puntatore resta valido fino alla prossima modifica dell'array.
      * 
+     * @return const value_type* primo elemento, nullptr se l'array non ha memoria allocata
      */
+    const value_type* data() const{
+        return _array;
+    }
 
-	class iterator {
-		//	
+    /**
+     * @brief Getter della capacità dell'array, ovvero del numero di elementi
+     * che possono essere contenuti senza riallocare la memoria.
+     * 
+     * @return size_type Capacità dell'array
+     */
+    size_type capacity() const{
+        return _capacity;
+    }
+
+    /**
+     * @brief Getter della politica di crescita della capacità
+     * 
+     * @return growth_policy politica di crescita attuale
+     */
+    growth_policy policy() const{
+        return _policy;
+    }
+
+    /**
+     * @brief Versione del contenuto dell'array: cambia ad ogni operazione che aggiunge, rimuove
+     * o riordina gli elementi, e può essere usata da strutture derivate (ad esempio EytzingerIndex)
+     * per sapere se devono essere ricostruite. Le modifiche attraverso gli iteratori non vengono
+     * rilevate finché non viene chiamata sort().
+     * 
+     * @return unsigned long versione attuale
+     */
+    unsigned long version() const{
+        return _version;
+    }
+
+    /**
+     * @brief Imposta la politica di crescita della capacità.
+     * Passando a MINIMAL la capacità in eccesso viene rilasciata subito.
+     * 
+     * @param policy nuova politica di crescita
+     */
+    void setPolicy(growth_policy policy){
+        _policy = policy;
+        if(_policy == MINIMAL){
+            shrink_to_fit();
+        }
+    }
+
+    /**
+     * @brief Iteratore di tipo random access che itera gli elementi dell'array in ordine.
+     * 
+     */
+
+	class iterator {
+		//	
 	public:
 		typedef std::random_access_iterator_tag iterator_category;
 		typedef T                        value_type;
@@ -556,52 +1172,1453 @@ class SortedArray{
 	}
 
     /**
-     * @brief Rimuove gli elementi dell'array che soddisfano la condizione F data in input come funtore.
+     * @brief Ricerca binaria del primo elemento che non precede element
+     * nell'ordinamento indotto dal funtore.
+     * 
+     * @param element elemento da cercare
+     * @return iterator iteratore al primo elemento non minore di element, o end()
+     */
+    iterator lower_bound(const value_type &element) {
+        SORTEDARRAY_TIME(LOOKUP);
+        return iterator(_array + lowerIndex(element));
+    }
+
+    /**
+     * @brief Ricerca binaria del primo elemento che segue element
+     * nell'ordinamento indotto dal funtore.
+     * 
+     * @param element elemento da cercare
+     * @return iterator iteratore al primo elemento maggiore di element, o end()
+     */
+    iterator upper_bound(const value_type &element) {
+        SORTEDARRAY_TIME(LOOKUP);
+        return iterator(_array + upperIndex(element));
+    }
+
+    /**
+     * @brief Ritorna l'intervallo degli elementi equivalenti ad element,
+     * ovvero quelli per cui il funtore non stabilisce un ordine rispetto ad element.
+     * 
+     * @param element elemento da cercare
+     * @return std::pair<iterator, iterator> coppia (lower_bound, upper_bound)
+     */
+    std::pair<iterator, iterator> equal_range(const value_type &element) {
+        return std::pair<iterator, iterator>(lower_bound(element), upper_bound(element));
+    }
+
+    /**
+     * @brief Ricerca binaria del primo elemento equivalente ad element.
+     * 
+     * @param element elemento da cercare
+     * @return iterator iteratore all'elemento trovato, o end() se assente
+     */
+    iterator find(const value_type &element) {
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type index = lowerIndex(element);
+        if(index != _size && !compare(element, _array[index])){
+            return iterator(_array + index);
+        }
+        return end();
+    }
+
+    /**
+     * @brief Costruisce un elemento a partire dagli argomenti dati e lo inserisce
+     * nella sua posizione, come push().
+     * 
+     * @tparam Args tipi degli argomenti del costruttore di T
+     * @param args argomenti del costruttore di T
+     * @return iterator iteratore all'elemento inserito
+     */
+    template<typename... Args>
+    iterator emplace(Args&&... args) {
+        size_type pos = insertSorted(value_type(std::forward<Args>(args)...));
+        return iterator(_array + pos);
+    }
+
+    /**
+     * @brief Aggiunge una copia di element solo se l'array non contiene un elemento equivalente
+     * secondo il funtore. La posizione viene trovata con una sola ricerca binaria.
+     * 
+     * @param element elemento da aggiungere all'array
+     * @return std::pair<iterator, bool> iteratore all'elemento inserito o a quello equivalente
+     * già presente, e true se l'elemento è stato inserito
+     */
+    std::pair<iterator, bool> insert_unique(const value_type &element) {
+        return insertUnique(element);
+    }
+
+    /**
+     * @brief Come insert_unique(const value_type &), ma l'elemento viene spostato nell'array invece che copiato.
+     * 
+     * @param element elemento da aggiungere all'array
+     * @return std::pair<iterator, bool> iteratore all'elemento inserito o a quello equivalente
+     * già presente, e true se l'elemento è stato inserito
+     */
+    std::pair<iterator, bool> insert_unique(value_type &&element) {
+        return insertUnique(std::move(element));
+    }
+
+    /**
+     * @brief Rimuove gli elementi equivalenti ad uno precedente secondo il funtore,
+     * mantenendo il primo di ogni gruppo. Gli elementi rimanenti vengono compattati
+     * in place con un solo passaggio, come in filter().
+     * 
+     * @return size_type numero di elementi rimossi
+     */
+    size_type unique() {
+        SORTEDARRAY_TIME(FILTER);
+        if(_size < 2){
+            return 0;
+        }
+
+        size_type slot = 1;
+        size_type i = 1;
+        try{
+            for(; i < _size; ++i){
+                if(compare(_array[slot - 1], _array[i])){
+                    if(slot != i){
+                        relocate(_array + i, 1, _array + slot);
+                    }
+                    ++slot;
+                } else {
+                    destroy(_array + i, _array + i + 1);
+                }
+            }
+        } catch(...){
+            abortCompaction(slot, i);
+            throw;
+        }
+        return truncate(slot);
+    }
+
+    /**
+     * @brief Rimuove l'elemento puntato dall'iteratore.
+     * 
+     * @param pos iteratore all'elemento da rimuovere, diverso da end()
+     * @return iterator iteratore all'elemento successivo a quello rimosso
+     */
+    iterator erase(iterator pos) {
+        assert(pos >= begin() && pos < end());
+        return erase(pos, pos + 1);
+    }
+
+    /**
+     * @brief Rimuove gli elementi nell'intervallo [first, last), spostando indietro
+     * in un solo passaggio gli elementi successivi. La capacità non cambia, tranne con
+     * la politica MINIMAL in cui viene rilasciata la memoria in eccesso.
+     * 
+     * @param first iteratore al primo elemento da rimuovere
+     * @param last iteratore successivo all'ultimo elemento da rimuovere
+     * @return iterator iteratore all'elemento che seguiva l'ultimo rimosso
+     */
+    iterator erase(iterator first, iterator last) {
+        SORTEDARRAY_TIME(ERASE);
+        assert(first >= begin() && first <= last && last <= end());
+        size_type from = first.ptr - _array;
+        size_type to = last.ptr - _array;
+
+        if(from != to){
+            destroy(_array + from, _array + to);
+            relocate(_array + to, _size - to, _array + from);
+            truncate(_size - (to - from));
+        }
+        return iterator(_array + from);
+    }
+
+    /**
+     * @brief Numero di elementi equivalenti ad element, calcolato con due ricerche binarie.
+     * 
+     * @param element elemento da cercare
+     * @return size_type numero di elementi equivalenti
+     */
+    size_type count(const value_type &element) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        return upperIndex(element) - lowerIndex(element);
+    }
+
+    /**
+     * @brief Come lower_bound(const value_type &), ma cerca una chiave di tipo K senza costruire un T.
+     * Disponibile solo se il funtore è trasparente (definisce is_transparent) e sa confrontare
+     * una chiave con un elemento in entrambi i versi.
+     * 
+     * @tparam K tipo della chiave
+     * @param key chiave da cercare
+     * @return iterator iteratore al primo elemento che non precede key, o end()
+     */
+    template<typename K, typename CC = C, typename = typename CC::is_transparent>
+    iterator lower_bound(const K &key) {
+        SORTEDARRAY_TIME(LOOKUP);
+        return iterator(_array + lowerIndex(key));
+    }
+
+    /**
+     * @brief Come upper_bound(const value_type &), per una chiave di tipo K (funtore trasparente).
+     * 
+     * @tparam K tipo della chiave
+     * @param key chiave da cercare
+     * @return iterator iteratore al primo elemento che segue key, o end()
+     */
+    template<typename K, typename CC = C, typename = typename CC::is_transparent>
+    iterator upper_bound(const K &key) {
+        SORTEDARRAY_TIME(LOOKUP);
+        return iterator(_array + upperIndex(key));
+    }
+
+    /**
+     * @brief Come find(const value_type &), per una chiave di tipo K (funtore trasparente).
+     * 
+     * @tparam K tipo della chiave
+     * @param key chiave da cercare
+     * @return iterator iteratore al primo elemento equivalente a key, o end() se assente
+     */
+    template<typename K, typename CC = C, typename = typename CC::is_transparent>
+    iterator find(const K &key) {
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type index = lowerIndex(key);
+        if(index != _size && !compare(key, _array[index])){
+            return iterator(_array + index);
+        }
+        return end();
+    }
+
+    /**
+     * @brief Come count(const value_type &), per una chiave di tipo K (funtore trasparente).
+     * 
+     * @tparam K tipo della chiave
+     * @param key chiave da cercare
+     * @return size_type numero di elementi equivalenti a key
+     */
+    template<typename K, typename CC = C, typename = typename CC::is_transparent>
+    size_type count(const K &key) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        return upperIndex(key) - lowerIndex(key);
+    }
+
+    /**
+     * @brief Cerca ogni chiave della sequenza [first, last) come find() e scrive in out,
+     * nello stesso ordine delle chiavi, l'iteratore al primo elemento equivalente o end().
+     * Finché le chiavi sono ordinate secondo il funtore l'array viene percorso una sola volta,
+     * cercando ogni chiave a partire dalla posizione della precedente con passi crescenti
+     * (O(m log(n/m)) confronti per m chiavi); dalla prima chiave fuori ordine le ricerche
+     * binarie vengono eseguite LANES alla volta, alternando i passi delle diverse chiavi e
+     * caricando in anticipo (prefetch) il prossimo elemento di ciascuna, in modo che le attese
+     * della memoria si sovrappongano.
+     * 
+     * @tparam Iter iteratore forward sulle chiavi (value_type o, con un funtore trasparente, chiavi)
+     * @tparam Out iteratore di output di iterator
+     * @param first iteratore alla prima chiave
+     * @param last iteratore successivo all'ultima chiave
+     * @param out destinazione dei risultati
+     * @return Out iteratore successivo all'ultimo risultato scritto
+     */
+    template<typename Iter, typename Out>
+    Out find_many(Iter first, Iter last, Out out) {
+        SORTEDARRAY_TIME(LOOKUP);
+        lookupMany(first, last, [this, &out](size_type index){ *out++ = iterator(_array + index); });
+        return out;
+    }
+
+    /**
+     * @brief Come find_many(), ma scrive in out true se l'array contiene un elemento
+     * equivalente alla chiave e false altrimenti.
      * 
+     * @tparam Iter iteratore forward sulle chiavi
+     * @tparam Out iteratore di output di bool
+     * @param first iteratore alla prima chiave
+     * @param last iteratore successivo all'ultima chiave
+     * @param out destinazione dei risultati
+     * @return Out iteratore successivo all'ultimo risultato scritto
+     */
+    template<typename Iter, typename Out>
+    Out contains_many(Iter first, Iter last, Out out) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        lookupMany(first, last, [this, &out](size_type index){ *out++ = index != _size; });
+        return out;
+    }
+
+    /**
+     * @brief Rimuove gli elementi dell'array che soddisfano la condizione F data in input come funtore.
+     * Gli elementi rimanenti vengono compattati in place con un solo passaggio, mantenendo
+     * il loro ordine relativo e senza allocare memoria.
+     * Per i tipi aritmetici la compattazione usa simd_kernels::compact(), ma il predicato è
+     * arbitrario e viene comunque chiamato una volta per elemento: è vettoriale solo lo
+     * spostamento degli elementi mantenuti, non la valutazione della condizione.
      * 
      * @tparam F 
      * @param parameter 
+     * @return size_type numero di elementi rimossi
      */
 
     template<typename F>
-    void filter(F parameter){
+    size_type filter(F parameter){
+        SORTEDARRAY_TIME(FILTER);
+
+        if constexpr(std::is_arithmetic<value_type>::value){
+            return truncate(simd_kernels::compact(_array, _size, parameter));
+        }
+        size_type slot = 0;
+        size_type i = 0;
+        try{
+            for(; i < _size; ++i){
+                if(!parameter(_array[i])){
+                    if(slot != i){
+                        relocate(_array + i, 1, _array + slot);
+                    }
+                    ++slot;
+                } else {
+                    destroy(_array + i, _array + i + 1);
+                }
+            }
+        } catch(...){
+            abortCompaction(slot, i);
+            throw;
+        }
+        return truncate(slot);
+    }
+
+    /**
+     * @brief Come filter(), ma gli elementi rimossi vengono spostati in un nuovo SortedArray.
+     * Poiché vengono estratti nell'ordine dell'array, il SortedArray risultante non deve essere riordinato.
+     * 
+     * @tparam F 
+     * @param parameter 
+     * @return SortedArray elementi che soddisfano la condizione, in ordine
+     */
+    template<typename F>
+    SortedArray partition_out(F parameter){
+        SORTEDARRAY_TIME(FILTER);
+
+        SortedArray removed(_policy, _alloc);
+        size_type slot = 0;
+        size_type i = 0;
+        try{
+            for(; i < _size; ++i){
+                if(parameter(_array[i])){
+                    removed.append(std::move(_array[i]));
+                    destroy(_array + i, _array + i + 1);
+                } else {
+                    if(slot != i){
+                        relocate(_array + i, 1, _array + slot);
+                    }
+                    ++slot;
+                }
+            }
+        } catch(...){
+            abortCompaction(slot, i);
+            throw;
+        }
+        truncate(slot);
+        return removed;
+    }
+
+    /**
+     * @brief Fonde this e other in un nuovo SortedArray con un solo passaggio lineare.
+     * Il risultato contiene tutti gli elementi di entrambi; tra elementi equivalenti
+     * quelli di this precedono quelli di other.
+     * 
+     * @param other SortedArray da fondere
+     * @return SortedArray elementi di this e di other, in ordine
+     */
+    SortedArray merge(const SortedArray &other) const {
+        SortedArray result(_policy, _alloc);
+        result.reserve(_size + other._size);
+        size_type i = 0;
+        size_type j = 0;
+        while(i < _size && j < other._size){
+            if(compare(other._array[j], _array[i])){
+                result.appendCopy(other._array[j++]);
+            } else {
+                result.appendCopy(_array[i++]);
+            }
+        }
+        result.appendCopies(_array + i, _array + _size);
+        result.appendCopies(other._array + j, other._array + other._size);
+        return result;
+    }
+
+    /**
+     * @brief Come merge(const SortedArray &), ma gli elementi di this e di other vengono spostati
+     * nel risultato invece di essere copiati: al termine this e other rimangono vuoti.
+     * Se il funtore lancia un'eccezione gli elementi già spostati rimangono nei due array,
+     * in uno stato valido ma non specificato.
+     * 
+     * @param other SortedArray da fondere
+     * @return SortedArray elementi di this e di other, in ordine
+     */
+    SortedArray merge(SortedArray &&other){
+        assert(this != &other);
+        SortedArray result(_policy, _alloc);
+        result.reserve(_size + other._size);
+        size_type i = 0;
+        size_type j = 0;
+        while(i < _size && j < other._size){
+            if(compare(other._array[j], _array[i])){
+                result.append(std::move(other._array[j++]));
+            } else {
+                result.append(std::move(_array[i++]));
+            }
+        }
+        // le code vengono trasferite in blocco: gli elementi spostati rimasti in [0, i) e [0, j)
+        // vengono distrutti da release()
+        result.relocate(_array + i, _size - i, result._array + result._size);
+        result._size += _size - i;
+        _size = i;
+        result.relocate(other._array + j, other._size - j, result._array + result._size);
+        result._size += other._size - j;
+        other._size = j;
+        release();
+        other.release();
+        return result;
+    }
+
+    /**
+     * @brief Unione di this e other in tempo lineare, con la semantica di std::set_union:
+     * di un elemento presente m volte in this ed n volte in other (secondo l'equivalenza
+     * del funtore) il risultato contiene max(m, n) copie, prese prima da this.
+     * 
+     * @param other SortedArray da unire
+     * @return SortedArray unione di this e other, in ordine
+     */
+    SortedArray set_union(const SortedArray &other) const {
+        SortedArray result(_policy, _alloc);
+        result.reserve(_size + other._size);
+        size_type i = 0;
+        size_type j = 0;
+        while(i < _size && j < other._size){
+            if(compare(_array[i], other._array[j])){
+                result.appendCopy(_array[i++]);
+            } else if(compare(other._array[j], _array[i])){
+                result.appendCopy(other._array[j++]);
+            } else {
+                result.appendCopy(_array[i++]);
+                ++j;
+            }
+        }
+        result.appendCopies(_array + i, _array + _size);
+        result.appendCopies(other._array + j, other._array + other._size);
+        if(_policy == MINIMAL){
+            result.shrink_to_fit();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Intersezione di this e other in tempo lineare, con la semantica di std::set_intersection:
+     * di un elemento presente m volte in this ed n volte in other il risultato contiene
+     * min(m, n) copie, prese da this.
+     * 
+     * @param other SortedArray da intersecare
+     * @return SortedArray elementi comuni a this e other, in ordine
+     */
+    SortedArray set_intersection(const SortedArray &other) const {
+        SortedArray result(_policy, _alloc);
+        result.reserve(std::min(_size, other._size));
+        size_type i = 0;
+        size_type j = 0;
+        while(i < _size && j < other._size){
+            if(compare(_array[i], other._array[j])){
+                ++i;
+            } else if(compare(other._array[j], _array[i])){
+                ++j;
+            } else {
+                result.appendCopy(_array[i++]);
+                ++j;
+            }
+        }
+        if(_policy == MINIMAL){
+            result.shrink_to_fit();
+        }
+        return result;
+    }
 
-        SortedArray<value_type, comparison> aux;
-        for(unsigned int i = 0; i < _size; ++i){
-            if(parameter(_array[i])){
-                aux.push(_array[i]);
+    /**
+     * @brief Differenza tra this e other in tempo lineare, con la semantica di std::set_difference:
+     * di un elemento presente m volte in this ed n volte in other il risultato contiene
+     * max(m - n, 0) copie.
+     * 
+     * @param other SortedArray degli elementi da escludere
+     * @return SortedArray elementi di this non presenti in other, in ordine
+     */
+    SortedArray set_difference(const SortedArray &other) const {
+        SortedArray result(_policy, _alloc);
+        result.reserve(_size);
+        size_type i = 0;
+        size_type j = 0;
+        while(i < _size && j < other._size){
+            if(compare(_array[i], other._array[j])){
+                result.appendCopy(_array[i++]);
+            } else if(compare(other._array[j], _array[i])){
+                ++j;
+            } else {
+                ++i;
+                ++j;
             }
         }
-        for(unsigned int i = 0; i <aux.size(); ++i){
-            remove(aux._array[i]);
+        result.appendCopies(_array + i, _array + _size);
+        if(_policy == MINIMAL){
+            result.shrink_to_fit();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Ritorna true se ogni elemento di other è presente in this, contando
+     * le ripetizioni (semantica di std::includes), con un solo passaggio lineare.
+     * 
+     * @param other SortedArray da verificare
+     * @return true 
+     * @return false 
+     */
+    bool includes(const SortedArray &other) const {
+        size_type i = 0;
+        size_type j = 0;
+        while(j < other._size){
+            if(i == _size || compare(other._array[j], _array[i])){
+                return false;
+            }
+            if(!compare(_array[i], other._array[j])){
+                ++j;
+            }
+            ++i;
         }
+        return true;
+    }
+
+    /**
+     * @brief Statistiche raccolte dall'array dalla sua costruzione o dall'ultimo resetStats().
+     * Le statistiche appartengono all'oggetto: non vengono copiate, spostate o scambiate con il contenuto.
+     * Se la macro SORTEDARRAY_STATS non è definita ritorna sempre statistiche vuote.
+     * 
+     * @return const sorted_array_stats& statistiche dell'array
+     */
+    const sorted_array_stats& stats() const {
+#ifdef SORTEDARRAY_STATS
+        return _stats;
+#else
+        static const sorted_array_stats empty;
+        return empty;
+#endif
+    }
+
+    /**
+     * @brief Azzera le statistiche dell'array.
+     * 
+     */
+    void resetStats(){
+#ifdef SORTEDARRAY_STATS
+        _stats.reset();
+#endif
     }
 
     /**
      * @brief Operatore di stream per SortedArray.
-     * Stampa a video gli elementi dell'array secondo l'ordine definito dall'utente e la capacità attuale. 
+     * Scrive in os gli elementi dell'array secondo l'ordine definito dall'utente e la capacità attuale. 
      * 
      * @param os 
      * @param arr 
      * @return std::ostream& 
      */
-    friend std::ostream& operator<<(std::ostream &os, const SortedArray<value_type, comparison> &arr) {
-        os << "Capacità: " <<  arr.size() << std::endl;
+    friend std::ostream& operator<<(std::ostream &os, const SortedArray &arr) {
+        os << "Capacità: " <<  arr.capacity() << std::endl;
         os << "Elementi in ordine: ";
         for(int i = 0; i < arr.size(); ++i){
-            std::cout << arr._array[i] << " ";
+            os << arr._array[i] << " ";
         }
-        std::cout << std::endl;
+        os << std::endl;
         return os;
     }
 
 
     private:
 
+    /**
+     * @brief Pila delle sequenze ordinate in attesa di essere fuse da sort().
+     * Le lunghezze crescono almeno come i numeri di Fibonacci, quindi 64 posizioni bastano
+     * per qualsiasi size_type.
+     */
+    struct run_stack {
+        size_type start[64];
+        size_type length[64];
+        int size;
+    };
+
+    /**
+     * @brief Ritorna true se conviene ordinare n elementi in parallelo con executor.
+     * 
+     * @param executor esecutore dei compiti paralleli
+     * @param n numero di elementi da ordinare
+     */
+    template<typename Executor>
+    static bool parallel(const Executor &executor, size_type n){
+        return std::is_nothrow_move_constructible<value_type>::value && executor.concurrency() > 1 &&
+               static_cast<std::size_t>(n) >= 2 * executor.threshold();
+    }
+
+    /**
+     * @brief Ordinamento parallelo di sort(Executor &). Le posizioni [0, sorted) sono già
+     * ordinate e formano la prima sequenza della fusione; le altre vengono divise in parti
+     * e ordinate dai compiti dell'esecutore.
+     * 
+     * @param executor esecutore dei compiti paralleli
+     * @param sorted numero di elementi iniziali già ordinati
+     */
+    template<typename Executor>
+    void parallelSort(Executor &executor, size_type sorted){
+        ++_version;
+        std::size_t unsorted = _size - sorted;
+        std::size_t tasks = std::max<std::size_t>(2, std::min(executor.concurrency(), unsorted / executor.threshold()));
+
+        // confini delle sequenze da fondere
+        std::vector<size_type> start;
+        if(sorted > 0){
+            start.push_back(0);
+        }
+        for(std::size_t t = 0; t <= tasks; ++t){
+            start.push_back(sorted + unsorted * t / tasks);
+        }
+        int runs = start.size() - 1;
+        int first = sorted > 0;
+
+        try{
+            executor.bulk(tasks, [this, &start, first](std::size_t t){
+                std::stable_sort(_array + start[first + t], _array + start[first + t + 1],
+                                 [this](const value_type &a, const value_type &b){ return _cmp(a, b); });
+            });
+
+            std::vector<size_type> bounds((tasks + 1) * runs);
+            for(std::size_t p = 0; p <= tasks; ++p){
+                splitRuns(start.data(), runs, partBegin(p, tasks), bounds.data() + p * runs);
+            }
+
+            value_type *out = allocate(_capacity);
+            std::vector<size_type> written(tasks, 0);
+            try{
+                executor.bulk(tasks, [this, &bounds, &written, runs, tasks, out](std::size_t p){
+                    mergeRuns(bounds.data() + p * runs, bounds.data() + (p + 1) * runs, runs, out + partBegin(p, tasks), written[p]);
+                });
+            } catch(...){
+                for(std::size_t p = 0; p < tasks; ++p){
+                    destroy(out + partBegin(p, tasks), out + partBegin(p, tasks) + written[p]);
+                }
+                deallocate(out, _capacity);
+                throw;
+            }
+            SORTEDARRAY_COUNT(moves, _size);
+            destroy(_array, _array + _size);
+            deallocate(_array, _capacity);
+            _array = out;
+        } catch(...){
+            release();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Prima posizione della parte p di parts in cui viene divisa la fusione di parallelSort().
+     * 
+     */
+    size_type partBegin(std::size_t p, std::size_t parts) const{
+        return static_cast<size_type>(static_cast<std::size_t>(_size) * p / parts);
+    }
+
+    /**
+     * @brief Divide le sequenze ordinate [start[j], start[j + 1]) in modo che le posizioni
+     * [start[j], pos[j]) contengano i primi rank elementi della loro fusione stabile.
+     * L'elemento di rango rank è il minimo, tra le sequenze, del primo elemento e tale che
+     * più di rank elementi non seguono e; degli elementi equivalenti ad esso vengono presi
+     * quelli delle sequenze precedenti.
+     * 
+     * @param start confini delle sequenze
+     * @param runs numero di sequenze
+     * @param rank numero di elementi a sinistra della divisione
+     * @param pos posizioni della divisione, una per sequenza
+     */
+    void splitRuns(const size_type *start, int runs, size_type rank, size_type *pos) const{
+        if(rank == _size){
+            std::copy(start + 1, start + runs + 1, pos);
+            return;
+        }
+
+        const value_type *pivot = nullptr;
+        for(int j = 0; j < runs; ++j){
+            // solo gli elementi che precedono il candidato attuale possono sostituirlo
+            size_type lo = start[j];
+            size_type hi = pivot == nullptr ? start[j + 1] : lowerIndex(*pivot, start[j], start[j + 1]);
+            size_type end = hi;
+            while(lo < hi){
+                size_type mid = lo + (hi - lo) / 2;
+                if(countNotAfter(start, runs, _array[mid]) > rank){
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+            if(lo < end){
+                pivot = _array + lo;
+            }
+        }
+
+        size_type before = 0;
+        for(int j = 0; j < runs; ++j){
+            pos[j] = lowerIndex(*pivot, start[j], start[j + 1]);
+            before += pos[j] - start[j];
+        }
+        size_type take = rank - before;
+        for(int j = 0; j < runs; ++j){
+            size_type equal = std::min(upperIndex(*pivot, pos[j], start[j + 1]) - pos[j], take);
+            pos[j] += equal;
+            take -= equal;
+        }
+    }
+
+    /**
+     * @brief Numero di elementi delle sequenze [start[j], start[j + 1]) che non seguono element.
+     * 
+     */
+    size_type countNotAfter(const size_type *start, int runs, const value_type &element) const{
+        size_type count = 0;
+        for(int j = 0; j < runs; ++j){
+            count += upperIndex(element, start[j], start[j + 1]) - start[j];
+        }
+        return count;
+    }
+
+    /**
+     * @brief Fusione a più vie delle sequenze [from[j], to[j]) nello spazio non inizializzato out,
+     * con uno heap delle sequenze ordinato per primo elemento e, a parità, per indice.
+     * Gli elementi vengono spostati ma non distrutti. Viene eseguita contemporaneamente
+     * ad altre fusioni, per cui usa il funtore direttamente, senza aggiornare le statistiche.
+     * 
+     * @param from inizio delle sequenze
+     * @param to fine delle sequenze
+     * @param runs numero di sequenze
+     * @param out destinazione
+     * @param written numero di elementi scritti in out, anche in caso di eccezione
+     */
+    void mergeRuns(const size_type *from, const size_type *to, int runs, value_type *out, size_type &written){
+        std::vector<size_type> head(from, from + runs);
+        std::vector<int> heap;
+        for(int j = 0; j < runs; ++j){
+            if(head[j] < to[j]){
+                heap.push_back(j);
+            }
+        }
+        // true se il primo elemento della sequenza a va scritto dopo quello della sequenza b
+        auto after = [this, &head](int a, int b){
+            const value_type &x = _array[head[a]];
+            const value_type &y = _array[head[b]];
+            return _cmp(y, x) || (a > b && !_cmp(x, y));
+        };
+        std::make_heap(heap.begin(), heap.end(), after);
+
+        size_type w = 0;
+        try{
+            while(!heap.empty()){
+                int j = heap.front();
+                std::pop_heap(heap.begin(), heap.end(), after);
+                alloc_traits::construct(_alloc, out + w, std::move(_array[head[j]]));
+                ++w;
+                if(++head[j] < to[j]){
+                    std::push_heap(heap.begin(), heap.end(), after);
+                } else {
+                    heap.pop_back();
+                }
+            }
+        } catch(...){
+            written = w;
+            throw;
+        }
+        written = w;
+    }
+
+    /**
+     * @brief Lunghezza minima delle sequenze di sort(): un valore tra 32 e 64 tale che
+     * n / minRun sia uguale o di poco inferiore ad una potenza di 2.
+     * 
+     * @param n numero di elementi da ordinare
+     * @return size_type lunghezza minima delle sequenze
+     */
+    static size_type minRunLength(size_type n){
+        size_type r = 0;
+        while(n >= 64){
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    /**
+     * @brief Lunghezza della sequenza ordinata che inizia in lo. Se la sequenza
+     * è strettamente decrescente viene invertita, preservando la stabilità.
+     * 
+     * @param lo posizione di inizio
+     * @return size_type lunghezza della sequenza
+     */
+    size_type countRun(size_type lo){
+        size_type hi = lo + 1;
+        if(hi == _size){
+            return 1;
+        }
+
+        if(compare(_array[hi], _array[lo])){
+            ++hi;
+            while(hi < _size && compare(_array[hi], _array[hi - 1])){
+                ++hi;
+            }
+            std::reverse(_array + lo, _array + hi);
+            SORTEDARRAY_COUNT(moves, 3 * ((hi - lo) / 2));
+        } else {
+            ++hi;
+            while(hi < _size && !compare(_array[hi], _array[hi - 1])){
+                ++hi;
+            }
+        }
+        return hi - lo;
+    }
+
+    /**
+     * @brief Insertion sort binario delle posizioni [lo, hi), sapendo che [lo, start) è già ordinato.
+     * 
+     * @param lo inizio dell'intervallo
+     * @param hi fine dell'intervallo
+     * @param start prima posizione non ancora ordinata
+     */
+    void binaryInsertionSort(size_type lo, size_type hi, size_type start){
+        for(size_type i = start; i < hi; ++i){
+            value_type pivot = std::move(_array[i]);
+            size_type pos = upperIndex(pivot, lo, i);
+            for(size_type j = i; j > pos; --j){
+                _array[j] = std::move(_array[j - 1]);
+            }
+            _array[pos] = std::move(pivot);
+            SORTEDARRAY_COUNT(moves, i - pos + 2);
+        }
+    }
+
+    /**
+     * @brief Fonde le sequenze adiacenti i e i + 1 della pila e aggiorna la pila.
+     * 
+     * @param runs pila delle sequenze
+     * @param i indice della prima sequenza
+     * @param buffer buffer temporaneo, allocato alla prima fusione
+     */
+    void mergeAt(run_stack &runs, int i, value_type *&buffer){
+        size_type lo = runs.start[i];
+        size_type mid = lo + runs.length[i];
+        size_type hi = mid + runs.length[i + 1];
+
+        runs.length[i] += runs.length[i + 1];
+        for(int j = i + 1; j < runs.size - 1; ++j){
+            runs.start[j] = runs.start[j + 1];
+            runs.length[j] = runs.length[j + 1];
+        }
+        --runs.size;
+
+        // gli elementi agli estremi che sono già nella posizione finale non vengono toccati
+        lo = upperIndex(_array[mid], lo, mid);
+        if(lo == mid){
+            return;
+        }
+        hi = lowerIndex(_array[mid - 1], mid, hi);
+
+        if(buffer == nullptr){
+            buffer = allocate(_size / 2 + 1);
+        }
+
+        if(mid - lo <= hi - mid){
+            size_type len = mid - lo;
+            relocate(_array + lo, len, buffer);
+            size_type b = 0;
+            size_type j = mid;
+            size_type w = lo;
+            try{
+                while(b < len && j < hi){
+                    if(compare(_array[j], buffer[b])){
+                        relocate(_array + j++, 1, _array + w++);
+                    } else {
+                        relocate(buffer + b++, 1, _array + w++);
+                    }
+                }
+            } catch(...){
+                // le celle libere [w, j) sono tante quante gli elementi rimasti nel buffer
+                relocate(buffer + b, len - b, _array + w);
+                throw;
+            }
+            relocate(buffer + b, len - b, _array + w);
+        } else {
+            size_type len = hi - mid;
+            relocate(_array + mid, len, buffer);
+            size_type b = len;
+            size_type j = mid;
+            size_type w = hi;
+            try{
+                while(b > 0 && j > lo){
+                    if(compare(buffer[b - 1], _array[j - 1])){
+                        relocate(_array + --j, 1, _array + --w);
+                    } else {
+                        relocate(buffer + --b, 1, _array + --w);
+                    }
+                }
+            } catch(...){
+                relocate(buffer, b, _array + j);
+                throw;
+            }
+            relocate(buffer, b, _array + lo);
+        }
+    }
+
+    /**
+     * @brief Confronta due elementi con il funtore, contando il confronto nelle statistiche.
+     * Uno dei due può essere una chiave, se il funtore è trasparente.
+     * 
+     * @param a primo elemento
+     * @param b secondo elemento
+     * @return true se a precede b
+     */
+    template<typename A, typename B>
+    bool compare(const A &a, const B &b) const{
+        SORTEDARRAY_COUNT(comparisons, 1);
+        return _cmp(a, b);
+    }
+
+    /**
+     * @brief Ricerca binaria della prima posizione il cui elemento non precede element
+     * nell'ordinamento indotto dal funtore (lower bound).
+     * 
+     * @tparam K tipo di element: value_type o, con un funtore trasparente, una chiave
+     * @param element elemento da cercare
+     * @return size_type indice del primo elemento e tale che _cmp(e, element) è false, o _size
+     */
+    template<typename K>
+    size_type lowerIndex(const K &element) const{
+        return lowerIndex(element, 0, _size);
+    }
+
+    /**
+     * @brief Lower bound di element limitato alle posizioni [first, last).
+     * 
+     * @param element elemento da cercare
+     * @param first prima posizione dell'intervallo
+     * @param last posizione successiva all'ultima dell'intervallo
+     * @return size_type indice del primo elemento dell'intervallo che non precede element, o last
+     */
+    template<typename K>
+    size_type lowerIndex(const K &element, size_type first, size_type last) const{
+        if constexpr(simd_search<K>::value){
+            return first + simd_kernels::lowerBound(_array + first, last - first, element);
+        }
+        size_type count = last - first;
+        while(count > 0){
+            size_type half = count / 2;
+            if(compare(_array[first + half], element)){
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Ricerca binaria della prima posizione il cui elemento segue element
+     * nell'ordinamento indotto dal funtore (upper bound).
+     * 
+     * @tparam K tipo di element: value_type o, con un funtore trasparente, una chiave
+     * @param element elemento da cercare
+     * @return size_type indice del primo elemento e tale che _cmp(element, e) è true, o _size
+     */
+    template<typename K>
+    size_type upperIndex(const K &element) const{
+        return upperIndex(element, 0, _size);
+    }
+
+    /**
+     * @brief Upper bound di element limitato alle posizioni [first, last).
+     * 
+     * @param element elemento da cercare
+     * @param first prima posizione dell'intervallo
+     * @param last posizione successiva all'ultima dell'intervallo
+     * @return size_type indice del primo elemento dell'intervallo che segue element, o last
+     */
+    template<typename K>
+    size_type upperIndex(const K &element, size_type first, size_type last) const{
+        if constexpr(simd_search<K>::value){
+            return first + simd_kernels::upperBound(_array + first, last - first, element);
+        }
+        size_type count = last - first;
+        while(count > 0){
+            size_type half = count / 2;
+            if(compare(element, _array[first + half])){
+                count = half;
+            } else {
+                first += half + 1;
+                count -= half + 1;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Numero di ricerche binarie eseguite insieme da lookupMany().
+     * 
+     */
+    static const int LANES = 8;
+
+    /**
+     * @brief Lower bound di element in [from, _size), sapendo che nessun elemento prima di from
+     * lo segue: la posizione viene delimitata con passi 1, 2, 4, ... a partire da from
+     * e poi cercata con una ricerca binaria.
+     * 
+     * @param element elemento da cercare
+     * @param from posizione di partenza
+     * @return size_type indice del primo elemento che non precede element, o _size
+     */
+    template<typename K>
+    size_type gallopLowerIndex(const K &element, size_type from) const{
+        size_type lo = from;
+        size_type hi = from;
+        size_type step = 1;
+        while(hi < _size && compare(_array[hi], element)){
+            lo = hi + 1;
+            hi = _size - lo > step ? lo + step : _size;
+            step *= 2;
+        }
+        return lowerIndex(element, lo, hi);
+    }
+
+    /**
+     * @brief Lower bound di lanes chiavi su tutto l'array, con le ricerche binarie eseguite
+     * insieme: a ogni passo tutte le chiavi dimezzano il loro intervallo e viene caricato
+     * in anticipo l'elemento che ciascuna confronterà al passo successivo.
+     * 
+     * @param keys iteratori alle chiavi
+     * @param pos risultati, uno per chiave
+     * @param lanes numero di chiavi, al più LANES
+     */
+    template<typename Iter>
+    void lowerIndexMany(const Iter *keys, size_type *pos, int lanes) const{
+        for(int l = 0; l < lanes; ++l){
+            pos[l] = 0;
+        }
+        if(_size == 0){
+            return;
+        }
+        // la posizione di ogni chiave è in [pos[l], pos[l] + len]
+        size_type len = _size;
+        while(len > 1){
+            size_type half = len / 2;
+            len -= half;
+            size_type ahead = len > 1 ? len / 2 - 1 : 0;
+            for(int l = 0; l < lanes; ++l){
+                pos[l] += half * compare(_array[pos[l] + half - 1], *keys[l]);
+#if defined(__GNUC__)
+                __builtin_prefetch(_array + pos[l] + ahead);
+#endif
+            }
+        }
+        for(int l = 0; l < lanes; ++l){
+            pos[l] += compare(_array[pos[l]], *keys[l]);
+        }
+    }
+
+    /**
+     * @brief Cerca le chiavi di [first, last) come descritto in find_many() e chiama emit,
+     * nell'ordine delle chiavi, con l'indice del primo elemento equivalente o _size.
+     * 
+     * @param first iteratore alla prima chiave
+     * @param last iteratore successivo all'ultima chiave
+     * @param emit funzione che riceve i risultati
+     */
+    template<typename Iter, typename F>
+    void lookupMany(Iter first, Iter last, F emit) const{
+        // la posizione di una chiave non precede quella della chiave precedente
+        // finché l'elemento prima di quest'ultima precede anche la nuova chiave
+        size_type cursor = 0;
+        for(; first != last; ++first){
+            if(cursor > 0 && !compare(_array[cursor - 1], *first)){
+                break;
+            }
+            cursor = gallopLowerIndex(*first, cursor);
+            emit(equivalentAt(*first, cursor));
+        }
+
+        Iter keys[LANES];
+        size_type pos[LANES];
+        while(first != last){
+            int lanes = 0;
+            for(; lanes < LANES && first != last; ++lanes, ++first){
+                keys[lanes] = first;
+            }
+            lowerIndexMany(keys, pos, lanes);
+            for(int l = 0; l < lanes; ++l){
+                emit(equivalentAt(*keys[l], pos[l]));
+            }
+        }
+    }
+
+    /**
+     * @brief Ritorna index se l'elemento in posizione index è equivalente ad element, _size altrimenti.
+     * 
+     * @param element elemento cercato
+     * @param index lower bound di element
+     * @return size_type index o _size
+     */
+    template<typename K>
+    size_type equivalentAt(const K &element, size_type index) const{
+        return index != _size && !compare(element, _array[index]) ? index : _size;
+    }
+
+    /**
+     * @brief Fonde l'array con k elementi ordinati partendo dal fondo, scrivendo
+     * nelle posizioni [0, _size + k). La capacità deve essere già sufficiente e _size
+     * non viene aggiornato. Gli elementi di batch vengono spostati ma non distrutti.
+     * Se k è piccolo rispetto a _size, per ogni elemento di batch la posizione viene trovata
+     * con una ricerca binaria e gli elementi dell'array che lo seguono vengono spostati in blocco.
+     * 
+     * @param batch elementi ordinati da inserire
+     * @param k numero di elementi di batch
+     */
+    void mergeBack(value_type *batch, size_type k){
+        size_type i = _size;
+        size_type j = k;
+        size_type w = _size + k;
+
+        try{
+            mergeBackStep(batch, i, j, w);
+        } catch(...){
+            // l'array ha celle libere in [i, w): viene svuotato come in sort()
+            destroy(_array, _array + i);
+            destroy(_array + w, _array + _size + k);
+            deallocate(_array, _capacity);
+            _array = nullptr;
+            _size = 0;
+            _capacity = 0;
+            ++_version;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Passo di fusione di mergeBack().
+     * Durante la fusione le celle [i, w) dell'array sono libere e sono tante quanti gli elementi
+     * di batch ancora da inserire (j).
+     * 
+     * @param batch elementi ordinati da inserire
+     * @param i numero di elementi dell'array non ancora spostati
+     * @param j numero di elementi di batch non ancora inseriti
+     * @param w posizione successiva all'ultima cella libera
+     */
+    void mergeBackStep(value_type *batch, size_type &i, size_type &j, size_type &w){
+        size_type k = j;
+
+        if(k * 8 < i){
+            while(j > 0){
+                size_type pos = upperIndex(batch[j - 1], 0, i);
+                relocate(_array + pos, i - pos, _array + w - (i - pos));
+                w -= i - pos;
+                i = pos;
+                alloc_traits::construct(_alloc, _array + --w, std::move(batch[--j]));
+                SORTEDARRAY_COUNT(moves, 1);
+            }
+            return;
+        }
+
+        while(j > 0){
+            if(i > 0 && compare(batch[j - 1], _array[i - 1])){
+                relocate(_array + --i, 1, _array + --w);
+            } else {
+                alloc_traits::construct(_alloc, _array + --w, std::move(batch[--j]));
+                SORTEDARRAY_COUNT(moves, 1);
+            }
+        }
+    }
+
+    /**
+     * @brief Scambia buffer, stato e allocatore con other, indipendentemente dalla
+     * politica di propagazione dell'allocatore: ogni buffer resta associato
+     * all'allocatore che lo ha allocato. Gli allocatori non assegnabili
+     * (come std::pmr::polymorphic_allocator) devono essere uguali.
+     * 
+     * @param other SortedArray da scambiare
+     */
+    void swapStorage(SortedArray &other) noexcept {
+        ++_version;
+        ++other._version;
+        std::swap(_array, other._array);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_policy, other._policy);
+        std::swap(_cmp, other._cmp);
+        storage::swapAllocators(_alloc, other._alloc);
+    }
+
+    /**
+     * @brief Inserisce element dopo gli elementi equivalenti, spostando in avanti
+     * gli elementi successivi.
+     * 
+     * @param element elemento da inserire
+     * @return size_type posizione dell'elemento inserito
+     */
+    size_type insertSorted(value_type &&element){
+        SORTEDARRAY_TIME(PUSH);
+        size_type pos = upperIndex(element);
+        insertAt(pos, std::move(element));
+        return pos;
+    }
+
+    /**
+     * @brief Inserisce element se non è presente un elemento equivalente.
+     * 
+     * @tparam V tipo di element (reference a value_type)
+     * @param element elemento da inserire
+     * @return std::pair<iterator, bool> posizione dell'elemento inserito o di quello equivalente,
+     * e true se l'inserimento è avvenuto
+     */
+    template<typename V>
+    std::pair<iterator, bool> insertUnique(V &&element){
+        SORTEDARRAY_TIME(PUSH);
+        size_type pos = lowerIndex(element);
+        if(pos != _size && !compare(element, _array[pos])){
+            return std::pair<iterator, bool>(iterator(_array + pos), false);
+        }
+        SORTEDARRAY_COUNT(copies, std::is_lvalue_reference<V>::value ? 1 : 0);
+        insertAt(pos, value_type(std::forward<V>(element)));
+        return std::pair<iterator, bool>(iterator(_array + pos), true);
+    }
+
+    /**
+     * @brief Inserisce element nella posizione pos, spostando in avanti gli elementi successivi.
+     * 
+     * @param pos posizione di inserimento, che deve rispettare l'ordinamento
+     * @param element elemento da inserire
+     */
+    void insertAt(size_type pos, value_type &&element){
+        size_type tail = _size - pos;
+        if(_size == _capacity){
+            grow(_size + 1);
+        }
+
+        relocate(_array + pos, tail, _array + pos + 1);
+        alloc_traits::construct(_alloc, _array + pos, std::move(element));
+        SORTEDARRAY_COUNT(moves, 1);
+        ++_size;
+        ++_version;
+    }
+
+    /**
+     * @brief Sposta element in coda all'array senza ricercarne la posizione.
+     * Il chiamante garantisce che element non preceda l'ultimo elemento.
+     * 
+     * @param element elemento da accodare
+     */
+    void append(value_type &&element){
+        if(_size == _capacity){
+            grow(_size + 1);
+        }
+        alloc_traits::construct(_alloc, _array + _size, std::move(element));
+        SORTEDARRAY_COUNT(moves, 1);
+        ++_size;
+    }
+
+    /**
+     * @brief Accoda una copia di element, che non deve precedere l'ultimo elemento.
+     * La capacità deve essere già sufficiente.
+     * 
+     * @param element elemento da copiare
+     */
+    void appendCopy(const value_type &element){
+        assert(_size < _capacity);
+        alloc_traits::construct(_alloc, _array + _size, element);
+        SORTEDARRAY_COUNT(copies, 1);
+        ++_size;
+    }
+
+    /**
+     * @brief Accoda una copia degli elementi di [first, last), come appendCopy().
+     * La capacità deve essere già sufficiente.
+     * 
+     * @param first primo elemento
+     * @param last elemento successivo all'ultimo
+     */
+    void appendCopies(const value_type *first, const value_type *last){
+        assert(_size + (last - first) <= _capacity);
+        constructFrom(first, last, _array + _size);
+        _size += last - first;
+    }
+
+    /**
+     * @brief Chiude una compattazione interrotta da un'eccezione: gli elementi non ancora
+     * esaminati, [i, _size), vengono spostati subito dopo i slot elementi mantenuti,
+     * per cui tutte le celle di [0, _size) tornano ad essere costruite.
+     * 
+     * @param slot numero di elementi già mantenuti, in [0, slot)
+     * @param i primo elemento non ancora esaminato
+     */
+    void abortCompaction(size_type slot, size_type i) noexcept {
+        if(slot != i){
+            relocate(_array + i, _size - i, _array + slot);
+            _size -= i - slot;
+            ++_version;
+        }
+    }
+
+    /**
+     * @brief Riduce il numero di elementi a newSize dopo che quelli in coda sono stati
+     * distrutti o spostati. Con la politica MINIMAL rilascia anche la memoria in eccesso.
+     * 
+     * @param newSize nuovo numero di elementi, non superiore a _size
+     * @return size_type numero di elementi scartati
+     */
+    size_type truncate(size_type newSize){
+        size_type removed = _size - newSize;
+        _size = newSize;
+        if(removed > 0){
+            ++_version;
+            if(_policy == MINIMAL){
+                shrink_to_fit();
+            }
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Cerca element tra gli elementi ad esso equivalenti e ritorna l'indice
+     * del primo uguale secondo l'operatore ==.
+     * 
+     * @param element elemento da cercare
+     * @return size_type indice dell'elemento, o _size se assente
+     */
+    size_type indexOf(const value_type &element) const{
+        SORTEDARRAY_TIME(LOOKUP);
+        if constexpr(simd_search<value_type>::value){
+            // sui tipi aritmetici gli elementi equivalenti sono uguali: basta il lower bound
+            size_type index = lowerIndex(element);
+            return index != _size && _array[index] == element ? index : _size;
+        }
+        size_type last = upperIndex(element);
+        for(size_type i = lowerIndex(element); i < last; ++i){
+            if(_array[i] == element){
+                return i;
+            }
+        }
+        return _size;
+    }
+
+    /**
+     * @brief Aumenta la capacità dell'array in modo da contenere almeno minCapacity elementi,
+     * secondo la politica di crescita impostata.
+     * 
+     * @param minCapacity capacità minima richiesta
+     */
+    void grow(size_type minCapacity){
+        reallocate(grownCapacity(_policy, _capacity, minCapacity));
+    }
+
+    /**
+     * @brief Sposta gli elementi in un nuovo buffer di capacità newCapacity.
+     * Se l'allocazione fallisce l'array rimane invariato.
+     * 
+     * @param newCapacity nuova capacità, non inferiore a _size
+     */
+    void reallocate(size_type newCapacity){
+        assert(newCapacity >= _size);
+        SORTEDARRAY_COUNT(reallocations, 1);
+        value_type *tmp = allocate(newCapacity);
+        relocate(_array, _size, tmp);
+        deallocate(_array, _capacity);
+        _array = tmp;
+        _capacity = newCapacity;
+    }
+
+    /**
+     * @brief Alloca spazio non inizializzato per n elementi (vedi sorted_storage).
+     * 
+     * @param n numero di elementi
+     * @return value_type* puntatore allo spazio allocato, nullptr se n è 0
+     */
+    value_type* allocate(size_type n){
+        if(n > 0){
+            SORTEDARRAY_COUNT(allocations, 1);
+            SORTEDARRAY_COUNT(bytes_allocated, n * sizeof(value_type));
+        }
+        return storage::allocate(_alloc, n);
+    }
+
+    /**
+     * @brief Rilascia lo spazio allocato con allocate(n).
+     * 
+     * @param p puntatore allo spazio, può essere nullptr
+     * @param n numero di elementi passato ad allocate()
+     */
+    void deallocate(value_type *p, size_type n){
+        storage::deallocate(_alloc, p, n);
+    }
+
+    /**
+     * @brief Distrugge gli elementi nell'intervallo [first, last).
+     * 
+     * @param first primo elemento
+     * @param last elemento successivo all'ultimo
+     */
+    void destroy(value_type *first, value_type *last){
+        storage::destroy(_alloc, first, last);
+    }
+
+    /**
+     * @brief Costruisce in dst una copia degli elementi di [first, last) (vedi sorted_storage).
+     * 
+     * @tparam Iter tipo degli iteratori
+     * @param first inizio della sequenza
+     * @param last fine della sequenza
+     * @param dst spazio non inizializzato di destinazione
+     */
+    template<typename Iter>
+    void constructFrom(Iter first, Iter last, value_type *dst){
+        value_type *end = storage::constructFrom(_alloc, first, last, dst);
+        SORTEDARRAY_COUNT(copies, end - dst);
+        (void)end;
+    }
+
+    /**
+     * @brief Sposta n elementi da src a dst, distruggendo gli originali (vedi sorted_storage).
+     * Non lancia eccezioni, poiché T ha un costruttore di spostamento noexcept (vedi static_assert).
+     * 
+     * @param src primo elemento da spostare
+     * @param n numero di elementi
+     * @param dst destinazione del primo elemento
+     */
+    void relocate(value_type *src, size_type n, value_type *dst) noexcept {
+        if(src != dst){
+            SORTEDARRAY_COUNT(moves, n);
+        }
+        storage::relocate(_alloc, src, n, dst);
+    }
+
+    /**
+     * @brief Distrugge tutti gli elementi e rilascia la memoria, lasciando l'array vuoto.
+     * 
+     */
+    void release(){
+        destroy(_array, _array + _size);
+        deallocate(_array, _capacity);
+        _array = nullptr;
+        _size = 0;
+        _capacity = 0;
+        ++_version;
+    }
+
 
     value_type *_array;
     size_type _size;
+    size_type _capacity;
+    growth_policy _policy;
     comparison _cmp;
+    allocator_type _alloc;
+    unsigned long _version = 0;
+#ifdef SORTEDARRAY_STATS
+    mutable sorted_array_stats _stats;
+#endif
 
 };
 
@@ -0,0 +1,597 @@
+#ifndef SortedArraySerialization_H
+#define SortedArraySerialization_H
+#include "SortedArray.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * @brief Identificativo del funtore di ordinamento registrato nei file e nei dati serializzati,
+ * per riconoscere gli elementi ordinati con un altro funtore.
+ *
+ * Di default è l'hash FNV-1a del nome restituito da typeid, che dipende dal compilatore:
+ * per dati scambiati tra programmi compilati diversamente va specializzato con un valore fisso.
+ *
+ * @tparam C funtore di ordinamento
+ */
+template<typename C>
+struct comparator_tag {
+    static std::uint64_t value(){
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for(const char *p = typeid(C).name(); *p; ++p){
+            h = (h ^ static_cast<unsigned char>(*p)) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+};
+
+/**
+ * @brief Checksum a 64 bit di [data, data + n), calcolato 8 byte alla volta.
+ * Rileva la corruzione accidentale dei dati, non è un hash crittografico.
+ *
+ * @param data primo byte
+ * @param n numero di byte
+ * @return std::uint64_t checksum
+ */
+inline std::uint64_t sorted_array_checksum(const char *data, std::size_t n){
+    if(n == 0){
+        return 0;
+    }
+    const std::uint64_t prime = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t h = n * prime;
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, data + i, n - i);
+    h = (h ^ tail) * prime;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief Destinazione dei byte codificati da un codec: un buffer in memoria a cui vengono accodati.
+ *
+ */
+class codec_writer{
+
+    public:
+
+    explicit codec_writer(std::vector<char> &buffer): _buffer(buffer) {}
+
+    /**
+     * @brief Accoda n byte.
+     *
+     */
+    void write(const void *data, std::size_t n){
+        const char *bytes = static_cast<const char*>(data);
+        _buffer.insert(_buffer.end(), bytes, bytes + n);
+    }
+
+    /**
+     * @brief Accoda la rappresentazione in memoria di value, di un tipo trivially copyable.
+     *
+     */
+    template<typename V>
+    void put(const V &value){
+        static_assert(std::is_trivially_copyable<V>::value, "put() richiede un tipo trivially copyable");
+        write(&value, sizeof(V));
+    }
+
+    private:
+
+    std::vector<char> &_buffer;
+};
+
+/**
+ * @brief Sorgente dei byte decodificati da un codec: un intervallo di memoria letto in ordine.
+ * La lettura oltre la fine solleva std::runtime_error.
+ *
+ */
+class codec_reader{
+
+    public:
+
+    codec_reader(const char *first, const char *last): _next(first), _last(last) {}
+
+    /**
+     * @brief Legge n byte.
+     *
+     */
+    void read(void *data, std::size_t n){
+        if(static_cast<std::size_t>(_last - _next) < n){
+            throw std::runtime_error("dati serializzati troncati");
+        }
+        std::memcpy(data, _next, n);
+        _next += n;
+    }
+
+    /**
+     * @brief Legge un valore di un tipo trivially copyable scritto con codec_writer::put().
+     *
+     */
+    template<typename V>
+    V get(){
+        static_assert(std::is_trivially_copyable<V>::value, "get() richiede un tipo trivially copyable");
+        V value;
+        read(&value, sizeof(V));
+        return value;
+    }
+
+    /**
+     * @brief Ritorna true se tutti i byte sono stati letti.
+     *
+     */
+    bool done() const {
+        return _next == _last;
+    }
+
+    private:
+
+    const char *_next;
+    const char *_last;
+};
+
+/**
+ * @brief Codec che scrive gli elementi nella loro rappresentazione in memoria.
+ * I blocchi di elementi vengono copiati con una sola memcpy, senza chiamare encode() e decode().
+ * Richiede un tipo trivially copyable e con costruttore di default.
+ *
+ * Un codec è un tipo con i metodi const
+ * - void encode(const T &, codec_writer &);
+ * - T decode(codec_reader &);
+ * e la costante element_size: il numero di byte per elemento se è fisso, 0 altrimenti.
+ * Se dichiara is_raw, encode() e decode() sono equivalenti a copiare sizeof(T) byte.
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T>
+struct raw_codec {
+
+    static_assert(std::is_trivially_copyable<T>::value, "raw_codec richiede un tipo trivially copyable");
+
+    typedef void is_raw;
+
+    static const std::uint32_t element_size = sizeof(T);
+
+    void encode(const T &element, codec_writer &out) const {
+        out.write(&element, sizeof(T));
+    }
+
+    T decode(codec_reader &in) const {
+        T element;
+        in.read(&element, sizeof(T));
+        return element;
+    }
+};
+
+/**
+ * @brief Codec formato da due funtori: encode(const T &, codec_writer &) e T decode(codec_reader &).
+ * Si costruisce con make_codec().
+ *
+ * @tparam T tipo degli elementi
+ * @tparam Encode funtore di codifica
+ * @tparam Decode funtore di decodifica
+ */
+template<typename T, typename Encode, typename Decode>
+struct functor_codec {
+
+    static const std::uint32_t element_size = 0;
+
+    functor_codec(Encode encoder, Decode decoder): _encode(encoder), _decode(decoder) {}
+
+    void encode(const T &element, codec_writer &out) const {
+        _encode(element, out);
+    }
+
+    T decode(codec_reader &in) const {
+        return _decode(in);
+    }
+
+    private:
+
+    Encode _encode;
+    Decode _decode;
+};
+
+/**
+ * @brief Crea un functor_codec per il tipo T.
+ *
+ * @tparam T tipo degli elementi
+ * @param encoder funtore chiamato con (const T &, codec_writer &)
+ * @param decoder funtore chiamato con (codec_reader &), che ritorna un T
+ * @return functor_codec<T, Encode, Decode>
+ */
+template<typename T, typename Encode, typename Decode>
+functor_codec<T, Encode, Decode> make_codec(Encode encoder, Decode decoder){
+    return functor_codec<T, Encode, Decode>(encoder, decoder);
+}
+
+/**
+ * @brief Vale true se il codec dichiara is_raw.
+ *
+ * @tparam Codec tipo del codec
+ */
+template<typename Codec, typename = void>
+struct is_raw_codec : std::false_type {};
+
+template<typename Codec>
+struct is_raw_codec<Codec, std::void_t<typename Codec::is_raw> > : std::true_type {};
+
+/**
+ * @brief Uscita dei dati serializzati su uno std::ostream.
+ * Un'uscita fornisce write(const char *, std::size_t) e solleva un'eccezione se non riesce.
+ *
+ */
+class stream_output{
+
+    public:
+
+    explicit stream_output(std::ostream &os): _os(os) {}
+
+    void write(const char *data, std::size_t n){
+        if(!_os.write(data, n)){
+            throw std::runtime_error("scrittura dei dati serializzati non riuscita");
+        }
+    }
+
+    private:
+
+    std::ostream &_os;
+};
+
+/**
+ * @brief Uscita dei dati serializzati in coda ad un buffer in memoria.
+ *
+ */
+class buffer_output{
+
+    public:
+
+    explicit buffer_output(std::vector<char> &buffer): _buffer(buffer) {}
+
+    void write(const char *data, std::size_t n){
+        _buffer.insert(_buffer.end(), data, data + n);
+    }
+
+    private:
+
+    std::vector<char> &_buffer;
+};
+
+/**
+ * @brief Ingresso dei dati serializzati da uno std::istream.
+ * Un ingresso fornisce read(char *, std::size_t) e solleva un'eccezione se i dati sono finiti.
+ *
+ */
+class stream_input{
+
+    public:
+
+    explicit stream_input(std::istream &is): _is(is) {}
+
+    void read(char *data, std::size_t n){
+        if(!_is.read(data, n)){
+            throw std::runtime_error("dati serializzati troncati");
+        }
+    }
+
+    private:
+
+    std::istream &_is;
+};
+
+/**
+ * @brief Ingresso dei dati serializzati da un intervallo di memoria.
+ *
+ */
+class buffer_input{
+
+    public:
+
+    buffer_input(const char *data, std::size_t n): _reader(data, data + n) {}
+
+    void read(char *data, std::size_t n){
+        _reader.read(data, n);
+    }
+
+    /**
+     * @brief Ritorna true se tutti i byte sono stati letti.
+     *
+     */
+    bool done() const {
+        return _reader.done();
+    }
+
+    private:
+
+    codec_reader _reader;
+};
+
+/**
+ * @brief Modalità di caricamento di deserialize().
+ * VERIFY_ORDER verifica in tempo lineare che gli elementi siano ordinati secondo il funtore
+ * dell'array e li ordina solo se non lo sono; TRUST_SORTED li accoda senza confrontarli,
+ * se i dati sono stati scritti con lo stesso funtore (comparator_tag), altrimenti li verifica.
+ */
+enum load_mode { VERIFY_ORDER, TRUST_SORTED };
+
+/**
+ * @brief Formato dei dati serializzati: un'intestazione, protetta dal proprio checksum, seguita
+ * da blocchi di al più chunk elementi (chunk non supera MAX_CHUNK), ognuno preceduto dal numero
+ * di elementi e di byte e seguito dal suo checksum.
+ * Serializzazione e caricamento tengono in memoria un solo blocco alla volta, oltre all'array.
+ *
+ */
+struct sorted_array_serialization {
+
+    static const std::uint32_t FORMAT_VERSION = 2;
+    static const std::uint32_t DEFAULT_CHUNK = 1 << 16;
+    static const std::uint32_t MAX_CHUNK = 1 << 24;
+    static const std::uint32_t READ_STEP = 1 << 20; // byte letti alla volta dai blocchi di dimensione variabile
+
+    struct header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t comparatorTag;
+        std::uint64_t count;
+        std::uint32_t elementSize;
+        std::uint32_t chunk;
+        std::uint64_t checksum; // checksum dei campi precedenti
+    };
+
+    struct chunk_header {
+        std::uint64_t count;
+        std::uint64_t bytes;
+    };
+
+    static const char* magic(){
+        return "SORTSER";
+    }
+
+    static std::uint32_t byteOrder(){
+        return 0x01020304;
+    }
+
+    /**
+     * @brief Checksum dei campi dell'intestazione che precedono checksum.
+     *
+     * @param h intestazione
+     * @return std::uint64_t checksum
+     */
+    static std::uint64_t headerChecksum(const header &h){
+        return sorted_array_checksum(reinterpret_cast<const char*>(&h), offsetof(header, checksum));
+    }
+
+    template<typename Output, typename V>
+    static void put(Output &out, const V &value){
+        out.write(reinterpret_cast<const char*>(&value), sizeof(V));
+    }
+
+    template<typename Input, typename V>
+    static void get(Input &in, V &value){
+        in.read(reinterpret_cast<char*>(&value), sizeof(V));
+    }
+};
+
+/**
+ * @brief Scrive arr su out nel formato di sorted_array_serialization, codificando gli elementi con codec.
+ * Con un codec raw i blocchi vengono scritti direttamente dalla memoria dell'array
+ * e letti direttamente nel buffer degli elementi.
+ *
+ * @tparam T tipo degli elementi
+ * @tparam C funtore di ordinamento
+ * @tparam Alloc allocatore
+ * @tparam Output tipo dell'uscita, ad esempio stream_output o buffer_output
+ * @tparam Codec tipo del codec
+ * @param arr array da serializzare
+ * @param out uscita
+ * @param codec codec degli elementi
+ * @param chunk numero massimo di elementi per blocco, tra 1 e MAX_CHUNK
+ */
+template<typename T, typename C, typename Alloc, typename Output, typename Codec = raw_codec<T> >
+void serializeTo(const SortedArray<T, C, Alloc> &arr, Output &out, const Codec &codec = Codec(),
+                 std::uint32_t chunk = sorted_array_serialization::DEFAULT_CHUNK){
+    typedef sorted_array_serialization format;
+    if(chunk == 0){
+        chunk = 1;
+    }
+    if(chunk > format::MAX_CHUNK){
+        chunk = format::MAX_CHUNK;
+    }
+    typename format::header header = {};
+    std::memcpy(header.magic, format::magic(), sizeof(header.magic));
+    header.version = format::FORMAT_VERSION;
+    header.byteOrder = format::byteOrder();
+    header.comparatorTag = comparator_tag<C>::value();
+    header.count = arr.size();
+    header.elementSize = Codec::element_size;
+    header.chunk = chunk;
+    header.checksum = format::headerChecksum(header);
+    format::put(out, header);
+
+    std::vector<char> buffer;
+    const T *elements = arr.data();
+    for(std::uint64_t first = 0; first < header.count; first += chunk){
+        std::uint64_t n = std::min<std::uint64_t>(chunk, header.count - first);
+        const char *bytes;
+        typename format::chunk_header chunkHeader = {n, 0};
+        if constexpr(is_raw_codec<Codec>::value){
+            bytes = reinterpret_cast<const char*>(elements + first);
+            chunkHeader.bytes = n * sizeof(T);
+        } else {
+            buffer.clear();
+            codec_writer writer(buffer);
+            for(std::uint64_t i = first; i < first + n; ++i){
+                codec.encode(elements[i], writer);
+            }
+            bytes = buffer.data();
+            chunkHeader.bytes = buffer.size();
+        }
+        format::put(out, chunkHeader);
+        out.write(bytes, chunkHeader.bytes);
+        format::put(out, sorted_array_checksum(bytes, chunkHeader.bytes));
+    }
+}
+
+/**
+ * @brief Sostituisce il contenuto di arr con gli elementi letti da in, scritti da serializeTo()
+ * con un codec equivalente. I blocchi vengono letti uno alla volta, verificandone il checksum,
+ * e accodati all'array con SortedArray::append_sorted(); con VERIFY_ORDER l'array viene
+ * ordinato alla fine solo se la verifica dell'ordine fallisce, confrontando gli elementi con
+ * il funtore di arr. La capacità cresce solo dopo la verifica di ogni blocco, per cui un numero
+ * di elementi falso nell'intestazione non causa allocazioni maggiori dei dati presenti.
+ *
+ * @tparam T tipo degli elementi
+ * @tparam C funtore di ordinamento
+ * @tparam Alloc allocatore
+ * @tparam Input tipo dell'ingresso, ad esempio stream_input o buffer_input
+ * @tparam Codec tipo del codec
+ * @param arr array da riempire
+ * @param in ingresso
+ * @param mode modalità di caricamento
+ * @param codec codec degli elementi
+ * @throws std::runtime_error se i dati sono troncati, danneggiati o scritti con un altro codec
+ */
+template<typename T, typename C, typename Alloc, typename Input, typename Codec = raw_codec<T> >
+void deserializeFrom(SortedArray<T, C, Alloc> &arr, Input &in, load_mode mode = VERIFY_ORDER, const Codec &codec = Codec()){
+    typedef sorted_array_serialization format;
+    typename format::header header;
+    format::get(in, header);
+    if(std::memcmp(header.magic, format::magic(), sizeof(header.magic)) != 0 || header.version != format::FORMAT_VERSION){
+        throw std::runtime_error("formato dei dati serializzati non riconosciuto");
+    }
+    if(header.checksum != format::headerChecksum(header)){
+        throw std::runtime_error("checksum dell'intestazione dei dati serializzati non valido");
+    }
+    if(header.byteOrder != format::byteOrder() || header.elementSize != Codec::element_size){
+        throw std::runtime_error("dati serializzati con un codec incompatibile");
+    }
+    if(header.count > static_cast<std::uint64_t>(std::numeric_limits<typename SortedArray<T, C, Alloc>::size_type>::max()) ||
+       header.chunk == 0 || header.chunk > format::MAX_CHUNK){
+        throw std::runtime_error("dati serializzati danneggiati");
+    }
+    bool trusted = mode == TRUST_SORTED && header.comparatorTag == comparator_tag<C>::value();
+
+    SortedArray<T, C, Alloc> loaded(arr.get_allocator());
+    loaded.setPolicy(arr.policy());
+    std::vector<char> buffer;
+    std::vector<T> elements;
+    bool sorted = true;
+    C cmp = arr.value_comp();
+    for(std::uint64_t read = 0; read < header.count; ){
+        typename format::chunk_header chunkHeader;
+        format::get(in, chunkHeader);
+        if(chunkHeader.count == 0 || chunkHeader.count > header.chunk || chunkHeader.count > header.count - read ||
+           (Codec::element_size != 0 && chunkHeader.bytes != chunkHeader.count * Codec::element_size) ||
+           (Codec::element_size == 0 && chunkHeader.bytes > (std::numeric_limits<std::uint32_t>::max)())){
+            throw std::runtime_error("dati serializzati danneggiati");
+        }
+        // con un codec raw i byte vengono letti direttamente negli elementi; con un codec di
+        // dimensione variabile la dimensione del blocco non è verificabile prima del checksum,
+        // per cui il buffer cresce a passi di READ_STEP byte insieme ai dati effettivamente letti
+        elements.clear();
+        char *bytes;
+        if constexpr(is_raw_codec<Codec>::value){
+            elements.resize(chunkHeader.count);
+            bytes = reinterpret_cast<char*>(elements.data());
+            in.read(bytes, chunkHeader.bytes);
+        } else {
+            buffer.clear();
+            while(buffer.size() < chunkHeader.bytes){
+                std::size_t done = buffer.size();
+                std::size_t step = static_cast<std::size_t>(std::min<std::uint64_t>(chunkHeader.bytes - done, format::READ_STEP));
+                buffer.resize(done + step);
+                in.read(buffer.data() + done, step);
+            }
+            bytes = buffer.data();
+        }
+        std::uint64_t checksum;
+        format::get(in, checksum);
+        if(checksum != sorted_array_checksum(bytes, chunkHeader.bytes)){
+            throw std::runtime_error("checksum dei dati serializzati non valido");
+        }
+        if constexpr(!is_raw_codec<Codec>::value){
+            codec_reader reader(bytes, bytes + chunkHeader.bytes);
+            for(std::uint64_t i = 0; i < chunkHeader.count; ++i){
+                elements.push_back(codec.decode(reader));
+            }
+            if(!reader.done()){
+                throw std::runtime_error("dati serializzati danneggiati");
+            }
+        }
+
+        if(!trusted && sorted){
+            sorted = std::is_sorted(elements.begin(), elements.end(), cmp) &&
+                (loaded.size() == 0 || !cmp(elements.front(), *(loaded.data() + loaded.size() - 1)));
+        }
+        // crescita geometrica limitata al numero di elementi dichiarato
+        std::uint64_t needed = loaded.size() + chunkHeader.count;
+        if(needed > static_cast<std::uint64_t>(loaded.capacity())){
+            std::uint64_t grown = std::max<std::uint64_t>(needed, 2 * static_cast<std::uint64_t>(loaded.capacity()));
+            loaded.reserve(static_cast<typename SortedArray<T, C, Alloc>::size_type>(std::min(grown, header.count)));
+        }
+        loaded.append_sorted(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+        read += chunkHeader.count;
+    }
+    if(!sorted){
+        loaded.sort();
+    }
+    arr.swap(loaded);
+}
+
+/**
+ * @brief Serializza arr su uno std::ostream, come serializeTo().
+ *
+ */
+template<typename T, typename C, typename Alloc, typename Codec = raw_codec<T> >
+void serialize(const SortedArray<T, C, Alloc> &arr, std::ostream &os, const Codec &codec = Codec(),
+               std::uint32_t chunk = sorted_array_serialization::DEFAULT_CHUNK){
+    stream_output out(os);
+    serializeTo(arr, out, codec, chunk);
+}
+
+/**
+ * @brief Serializza arr in coda a buffer, come serializeTo().
+ *
+ */
+template<typename T, typename C, typename Alloc, typename Codec = raw_codec<T> >
+void serialize(const SortedArray<T, C, Alloc> &arr, std::vector<char> &buffer, const Codec &codec = Codec(),
+               std::uint32_t chunk = sorted_array_serialization::DEFAULT_CHUNK){
+    buffer_output out(buffer);
+    serializeTo(arr, out, codec, chunk);
+}
+
+/**
+ * @brief Carica arr da uno std::istream, come deserializeFrom().
+ *
+ */
+template<typename T, typename C, typename Alloc, typename Codec = raw_codec<T> >
+void deserialize(SortedArray<T, C, Alloc> &arr, std::istream &is, load_mode mode = VERIFY_ORDER, const Codec &codec = Codec()){
+    stream_input in(is);
+    deserializeFrom(arr, in, mode, codec);
+}
+
+/**
+ * @brief Carica arr da un buffer scritto da serialize(), come deserializeFrom().
+ *
+ */
+template<typename T, typename C, typename Alloc, typename Codec = raw_codec<T> >
+void deserialize(SortedArray<T, C, Alloc> &arr, const std::vector<char> &buffer, load_mode mode = VERIFY_ORDER, const Codec &codec = Codec()){
+    buffer_input in(buffer.data(), buffer.size());
+    deserializeFrom(arr, in, mode, codec);
+}
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef SortedArraySimd_H
+#define SortedArraySimd_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORTEDARRAY_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Descrive l'ordinamento indotto da un funtore di confronto su tipi aritmetici.
+ *
+ * order vale 1 se il funtore equivale a a < b (ordine crescente), -1 se equivale a a > b
+ * (ordine decrescente) e 0 se non è noto. value_type è il tipo degli argomenti del funtore,
+ * void se il funtore accetta qualsiasi tipo aritmetico.
+ * Le specializzazioni permettono a SortedArray di usare i kernel di sorted_array_simd
+ * invece di chiamare il funtore; vanno definite solo per funtori che confrontano
+ * esattamente con < o >.
+ *
+ * @tparam C funtore di ordinamento
+ */
+template<typename C>
+struct comparator_traits {
+    static const int order = 0;
+    typedef void value_type;
+};
+
+template<typename T>
+struct comparator_traits<std::less<T> > {
+    static const int order = 1;
+    typedef T value_type;
+};
+
+template<typename T>
+struct comparator_traits<std::greater<T> > {
+    static const int order = -1;
+    typedef T value_type;
+};
+
+/**
+ * @brief Vale true se i kernel di sorted_array_simd possono sostituire il funtore C
+ * sugli elementi di tipo T.
+ *
+ * @tparam T tipo degli elementi
+ * @tparam C funtore di ordinamento
+ */
+template<typename T, typename C>
+struct has_simd_order : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && comparator_traits<C>::order != 0 &&
+    (std::is_same<typename comparator_traits<C>::value_type, T>::value ||
+     std::is_void<typename comparator_traits<C>::value_type>::value)> {};
+
+/**
+ * @brief Kernel di ricerca e di compattazione per array ordinati di tipi aritmetici.
+ *
+ * La ricerca binaria non contiene salti condizionati e si ferma su un blocco di al più
+ * BLOCK elementi, in cui la posizione viene calcolata contando gli elementi che precedono
+ * la chiave; per gli int il conteggio usa istruzioni AVX2 (8 elementi per confronto) se la CPU
+ * le supporta, verificato una sola volta durante l'esecuzione, altrimenti SSE2. Sugli altri
+ * tipi e sulle altre architetture viene usato il codice scalare.
+ *
+ * @tparam T tipo aritmetico degli elementi
+ * @tparam Descending true se l'array è in ordine decrescente
+ */
+template<typename T, bool Descending>
+struct sorted_array_simd {
+
+    static const std::size_t BLOCK = 16;
+
+    /**
+     * @brief Prima posizione di [a, a + n) il cui elemento non precede key.
+     *
+     * @param a primo elemento
+     * @param n numero di elementi
+     * @param key chiave da cercare
+     * @return std::size_t posizione trovata, n se tutti gli elementi precedono key
+     */
+    static std::size_t lowerBound(const T *a, std::size_t n, T key){
+        return bound<false>(a, n, key);
+    }
+
+    /**
+     * @brief Prima posizione di [a, a + n) il cui elemento segue key.
+     *
+     * @param a primo elemento
+     * @param n numero di elementi
+     * @param key chiave da cercare
+     * @return std::size_t posizione trovata, n se nessun elemento segue key
+     */
+    static std::size_t upperBound(const T *a, std::size_t n, T key){
+        return bound<true>(a, n, key);
+    }
+
+    /**
+     * @brief Compatta in place gli elementi di [a, a + n) che non soddisfano remove,
+     * mantenendone l'ordine. Il predicato viene chiamato una volta per elemento, in ordine.
+     * Per gli int con AVX2 gli elementi mantenuti vengono spostati 8 alla volta con una permutazione.
+     *
+     * @tparam F tipo del predicato
+     * @param a primo elemento
+     * @param n numero di elementi
+     * @param remove predicato degli elementi da rimuovere
+     * @return std::size_t numero di elementi mantenuti, ora in [a, a + risultato)
+     */
+    template<typename F>
+    static std::size_t compact(T *a, std::size_t n, F &remove){
+        std::size_t slot = 0;
+        std::size_t i = 0;
+#if defined(SORTEDARRAY_X86)
+        if(std::is_same<T, std::int32_t>::value && hasAvx2()){
+            const std::int32_t *table = compactTable();
+            while(i + 8 <= n){
+                unsigned mask = 0;
+                for(int j = 0; j < 8; ++j){
+                    mask |= static_cast<unsigned>(!remove(a[i + j])) << j;
+                }
+                slot = compactBlockAvx2(reinterpret_cast<std::int32_t*>(a), i, slot, table, mask);
+                i += 8;
+            }
+        }
+#endif
+        for(; i < n; ++i){
+            T x = a[i];
+            a[slot] = x;
+            slot += !remove(x);
+        }
+        return slot;
+    }
+
+    private:
+
+    /**
+     * @brief Vale true se x precede key (Upper false) o se non lo segue (Upper true).
+     *
+     */
+    template<bool Upper>
+    static bool before(T x, T key){
+        if(Upper){
+            return Descending ? !(key > x) : !(key < x);
+        }
+        return Descending ? x > key : x < key;
+    }
+
+    template<bool Upper>
+    static std::size_t bound(const T *a, std::size_t n, T key){
+        const T *base = a;
+        std::size_t len = n;
+        // la posizione cercata è sempre in [base, base + len]
+        while(len > BLOCK){
+            std::size_t half = len / 2;
+            base += half * before<Upper>(base[half - 1], key);
+            len -= half;
+        }
+        return (base - a) + countBefore<Upper>(base, len, key);
+    }
+
+    /**
+     * @brief Numero di elementi di [p, p + len) che precedono key (o non lo seguono, se Upper).
+     * Poiché il blocco è ordinato, è anche la posizione della chiave al suo interno.
+     *
+     */
+    template<bool Upper>
+    static std::size_t countBefore(const T *p, std::size_t len, T key){
+        std::size_t count = 0;
+        std::size_t i = 0;
+#if defined(SORTEDARRAY_X86)
+        if(std::is_same<T, std::int32_t>::value){
+            const std::int32_t *q = reinterpret_cast<const std::int32_t*>(p);
+            std::int32_t k = static_cast<std::int32_t>(key);
+            if(hasAvx2()){
+                count = countBlockAvx2(q, len, k, Descending != Upper, Upper);
+                i = len - len % 8;
+            } else {
+                count = countBlockSse2(q, len, k, Descending != Upper, Upper);
+                i = len - len % 4;
+            }
+        }
+#endif
+        for(; i < len; ++i){
+            count += before<Upper>(p[i], key);
+        }
+        return count;
+    }
+
+#if defined(SORTEDARRAY_X86)
+
+    /**
+     * @brief Verifica, una sola volta, se la CPU supporta AVX2.
+     *
+     */
+    static bool hasAvx2(){
+        static const bool supported = [](){
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }();
+        return supported;
+    }
+
+    /**
+     * @brief Conta sui blocchi completi di 8 elementi di [p, p + len) quelli per cui
+     * p[i] > key (greater) o key > p[i] (!greater); con negate conta il complementare.
+     *
+     */
+    __attribute__((target("avx2")))
+    static std::size_t countBlockAvx2(const std::int32_t *p, std::size_t len, std::int32_t key, bool greater, bool negate){
+        __m256i k = _mm256_set1_epi32(key);
+        std::size_t count = 0;
+        std::size_t full = len - len % 8;
+        for(std::size_t i = 0; i < full; i += 8){
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i m = greater ? _mm256_cmpgt_epi32(x, k) : _mm256_cmpgt_epi32(k, x);
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        }
+        return negate ? full - count : count;
+    }
+
+    /**
+     * @brief Come countBlockAvx2, su blocchi di 4 elementi con SSE2.
+     *
+     */
+    static std::size_t countBlockSse2(const std::int32_t *p, std::size_t len, std::int32_t key, bool greater, bool negate){
+        __m128i k = _mm_set1_epi32(key);
+        std::size_t count = 0;
+        std::size_t full = len - len % 4;
+        for(std::size_t i = 0; i < full; i += 4){
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i m = greater ? _mm_cmpgt_epi32(x, k) : _mm_cmpgt_epi32(k, x);
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(m)));
+        }
+        return negate ? full - count : count;
+    }
+
+    /**
+     * @brief Tabella delle permutazioni che portano in testa, in ordine, le posizioni
+     * dei bit a 1 di ogni maschera di 8 bit.
+     *
+     */
+    static const std::int32_t* compactTable(){
+        static std::int32_t table[256][8];
+        static const bool built = [](){
+            for(int mask = 0; mask < 256; ++mask){
+                int w = 0;
+                for(int j = 0; j < 8; ++j){
+                    if(mask & (1 << j)){
+                        table[mask][w++] = j;
+                    }
+                }
+                for(; w < 8; ++w){
+                    table[mask][w] = 0;
+                }
+            }
+            return true;
+        }();
+        (void)built;
+        return &table[0][0];
+    }
+
+    /**
+     * @brief Scrive in a + slot gli elementi di [a + i, a + i + 8) indicati da mask, usando
+     * la permutazione corrispondente di compactTable(). slot non supera i, quindi la scrittura
+     * non tocca elementi non ancora letti.
+     *
+     * @return std::size_t nuova posizione di scrittura
+     */
+    __attribute__((target("avx2")))
+    static std::size_t compactBlockAvx2(std::int32_t *a, std::size_t i, std::size_t slot, const std::int32_t *table, unsigned mask){
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i perm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table + mask * 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + slot), _mm256_permutevar8x32_epi32(x, perm));
+        return slot + __builtin_popcount(mask);
+    }
+
+#endif
+
+};
+
+#endif
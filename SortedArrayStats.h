@@ -0,0 +1,93 @@
+#ifndef SortedArrayStats_H
+#define SortedArrayStats_H
+#include <chrono>
+
+/**
+ * @brief Statistiche delle operazioni di un SortedArray.
+ *
+ * Vengono raccolte solo se la macro SORTEDARRAY_STATS è definita prima di includere
+ * SortedArray.h (ad esempio con -DSORTEDARRAY_STATS); altrimenti i contatori non esistono
+ * nella classe, le istruzioni che li aggiornano non generano codice e stats() ritorna
+ * sempre statistiche vuote.
+ */
+struct sorted_array_stats {
+
+    /**
+     * @brief Operazioni di cui viene misurato il tempo.
+     *
+     */
+    enum operation { PUSH, INSERT, ERASE, FILTER, SORT, LOOKUP, OPERATIONS };
+
+    unsigned long long comparisons;     // chiamate al funtore di ordinamento
+    unsigned long long copies;          // elementi costruiti per copia
+    unsigned long long moves;           // elementi spostati o riposizionati
+    unsigned long long allocations;     // buffer ottenuti dall'allocatore
+    unsigned long long reallocations;   // cambi di capacità dell'array
+    unsigned long long bytes_allocated; // byte richiesti all'allocatore
+    unsigned long long calls[OPERATIONS]; // chiamate di ogni operazione
+    unsigned long long ns[OPERATIONS];    // tempo totale di ogni operazione in nanosecondi
+
+    sorted_array_stats(){
+        reset();
+    }
+
+    /**
+     * @brief Azzera tutti i contatori.
+     *
+     */
+    void reset(){
+        comparisons = 0;
+        copies = 0;
+        moves = 0;
+        allocations = 0;
+        reallocations = 0;
+        bytes_allocated = 0;
+        for(int i = 0; i < OPERATIONS; ++i){
+            calls[i] = 0;
+            ns[i] = 0;
+        }
+    }
+
+};
+
+#ifdef SORTEDARRAY_STATS
+
+/**
+ * @brief Misura il tempo di un'operazione dalla costruzione alla distruzione
+ * e lo aggiunge alle statistiche.
+ *
+ */
+class sorted_array_timer {
+
+    public:
+
+    sorted_array_timer(sorted_array_stats &stats, sorted_array_stats::operation op)
+        : _stats(stats), _op(op), _start(std::chrono::steady_clock::now()) {
+
+    }
+
+    ~sorted_array_timer(){
+        std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+        ++_stats.calls[_op];
+        _stats.ns[_op] += elapsed.count();
+    }
+
+    private:
+
+    sorted_array_stats &_stats;
+    sorted_array_stats::operation _op;
+    std::chrono::steady_clock::time_point _start;
+
+};
+
+#define SORTEDARRAY_COUNT(field, n) (_stats.field += (n))
+#define SORTEDARRAY_TIME(op) sorted_array_timer sortedArrayTimer(_stats, sorted_array_stats::op)
+
+#else
+
+#define SORTEDARRAY_COUNT(field, n) ((void)0)
+#define SORTEDARRAY_TIME(op) ((void)0)
+
+#endif
+
+#endif
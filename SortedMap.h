@@ -0,0 +1,997 @@
+#ifndef SortedMap_H
+#define SortedMap_H
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <initializer_list>
+#include <iostream>
+#include "SortedArray.h"
+
+/**
+ * @brief Mappa ordinata piatta (flat map) con chiavi e valori in array separati.
+ *
+ * Le chiavi sono mantenute ordinate secondo il funtore C in un array contiguo, e i valori
+ * in un secondo array parallelo (structure of arrays): le ricerche binarie leggono solo
+ * le chiavi, per cui ogni linea di cache caricata contiene solo dati utili al confronto.
+ * Ogni chiave è presente al più una volta, secondo l'equivalenza del funtore.
+ *
+ * Se il funtore è trasparente (definisce is_transparent) find(), count(), lower_bound()
+ * e upper_bound() accettano qualsiasi tipo confrontabile con K, senza costruire una chiave.
+ *
+ * La memoria è gestita con le stesse funzioni di SortedArray (sorted_storage): spazio non inizializzato
+ * tramite std::allocator_traits, politica di crescita GEOMETRIC o MINIMAL e memmove per i tipi banalmente
+ * copiabili. Come in SortedArray, K e V devono essere banalmente copiabili o avere un costruttore di
+ * spostamento noexcept, così che lo spostamento dei due array paralleli non possa fallire a metà
+ * lasciando chiavi e valori disallineati.
+ *
+ * Definendo la macro SORTEDARRAY_STATS la mappa raccoglie le stesse statistiche di SortedArray (vedi stats()).
+ *
+ * @tparam K tipo delle chiavi
+ * @tparam V tipo dei valori
+ * @tparam C funtore di ordinamento delle chiavi
+ * @tparam Alloc allocatore delle chiavi, da cui viene ricavato quello dei valori
+ */
+template<typename K, typename V, typename C, typename Alloc = std::allocator<K> >
+class SortedMap : public sorted_growth {
+
+    static_assert(std::is_trivially_copyable<K>::value || std::is_nothrow_move_constructible<K>::value,
+        "SortedMap richiede chiavi banalmente copiabili o con costruttore di spostamento noexcept");
+    static_assert(std::is_trivially_copyable<V>::value || std::is_nothrow_move_constructible<V>::value,
+        "SortedMap richiede valori banalmente copiabili o con costruttore di spostamento noexcept");
+
+    typedef std::allocator_traits<Alloc> key_traits;
+    typedef typename key_traits::template rebind_alloc<V> value_allocator;
+    typedef std::allocator_traits<value_allocator> value_traits;
+    typedef sorted_storage<Alloc> key_storage;
+    typedef sorted_storage<value_allocator> value_storage;
+
+    /**
+     * @brief Vale true se il funtore definisce is_transparent.
+     *
+     */
+    template<typename F, typename = void>
+    struct is_transparent : std::false_type {};
+
+    template<typename F>
+    struct is_transparent<F, typename std::conditional<true, void, typename F::is_transparent>::type> : std::true_type {};
+
+    /**
+     * @brief Tipo con cui viene cercata una chiave di tipo Q: Q stesso se il funtore è trasparente,
+     * altrimenti K (la chiave viene convertita una sola volta, prima della ricerca).
+     *
+     */
+    template<typename Q>
+    using lookup_type = typename std::conditional<is_transparent<C>::value, Q, K>::type;
+
+    public:
+
+    typedef int size_type;
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef C key_compare;
+    typedef Alloc allocator_type;
+
+    /**
+     * @brief Iteratore random access sulle coppie (chiave, valore) in ordine di chiave.
+     * Il dereferenziamento ritorna una coppia di reference, std::pair<const K&, V&>:
+     * la chiave non può essere modificata, il valore sì se Const è false.
+     * iterator e const_iterator sono le due istanze del template; iterator è convertibile in const_iterator.
+     *
+     * @tparam Const true se il valore è accessibile in sola lettura
+     */
+    template<bool Const>
+    class basic_iterator {
+
+        typedef typename std::conditional<Const, const V, V>::type mapped_ref;
+
+        public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::pair<const K, V>           value_type;
+        typedef ptrdiff_t                       difference_type;
+        typedef std::pair<const K&, mapped_ref&> reference;
+
+        /**
+         * @brief Puntatore restituito da operator->: contiene la coppia di reference.
+         *
+         */
+        struct pointer {
+            reference pair;
+
+            reference* operator->() {
+                return &pair;
+            }
+        };
+
+        basic_iterator(): _key(nullptr), _value(nullptr) {
+
+        }
+
+        /**
+         * @brief Conversione da iterator a const_iterator.
+         *
+         * @param other iteratore da convertire
+         */
+        template<bool B, typename = typename std::enable_if<Const && !B>::type>
+        basic_iterator(const basic_iterator<B> &other): _key(other._key), _value(other._value) {
+
+        }
+
+        /**
+         * @brief Ritorna la coppia (chiave, valore) riferita dall'iteratore.
+         *
+         * @return reference coppia di reference a chiave e valore
+         */
+        reference operator*() const {
+            return reference(*_key, *_value);
+        }
+
+        pointer operator->() const {
+            return pointer{reference(*_key, *_value)};
+        }
+
+        reference operator[](difference_type index) const {
+            return reference(_key[index], _value[index]);
+        }
+
+        /**
+         * @brief Chiave riferita dall'iteratore.
+         *
+         * @return const K& chiave
+         */
+        const K& key() const {
+            return *_key;
+        }
+
+        /**
+         * @brief Valore riferito dall'iteratore.
+         *
+         * @return mapped_ref& valore
+         */
+        mapped_ref& value() const {
+            return *_value;
+        }
+
+        basic_iterator& operator++() {
+            ++_key;
+            ++_value;
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        basic_iterator& operator--() {
+            --_key;
+            --_value;
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator old(*this);
+            --*this;
+            return old;
+        }
+
+        basic_iterator& operator+=(difference_type offset) {
+            _key += offset;
+            _value += offset;
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type offset) {
+            _key -= offset;
+            _value -= offset;
+            return *this;
+        }
+
+        basic_iterator operator+(difference_type offset) const {
+            return basic_iterator(_key + offset, _value + offset);
+        }
+
+        basic_iterator operator-(difference_type offset) const {
+            return basic_iterator(_key - offset, _value - offset);
+        }
+
+        difference_type operator-(const basic_iterator &other) const {
+            return _key - other._key;
+        }
+
+        bool operator==(const basic_iterator &other) const {
+            return _key == other._key;
+        }
+
+        bool operator!=(const basic_iterator &other) const {
+            return _key != other._key;
+        }
+
+        bool operator<(const basic_iterator &other) const {
+            return _key < other._key;
+        }
+
+        bool operator<=(const basic_iterator &other) const {
+            return _key <= other._key;
+        }
+
+        bool operator>(const basic_iterator &other) const {
+            return _key > other._key;
+        }
+
+        bool operator>=(const basic_iterator &other) const {
+            return _key >= other._key;
+        }
+
+        private:
+
+        friend class SortedMap;
+
+        template<bool B>
+        friend class basic_iterator;
+
+        basic_iterator(const K *key, mapped_ref *value): _key(key), _value(value) {
+
+        }
+
+        const K *_key;
+        mapped_ref *_value;
+
+    };
+
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true> const_iterator;
+
+    /**
+     * @brief Costruttore di default: crea una mappa vuota.
+     *
+     * @param policy politica di crescita della capacità
+     * @param alloc allocatore da utilizzare
+     */
+    SortedMap(growth_policy policy = GEOMETRIC, const allocator_type &alloc = allocator_type())
+        : _keys(nullptr), _values(nullptr), _size(0), _capacity(0), _policy(policy), _keyAlloc(alloc), _valueAlloc(alloc) {
+
+    }
+
+    /**
+     * @brief Crea una mappa vuota con politica di crescita GEOMETRIC e l'allocatore dato.
+     *
+     * @param alloc allocatore da utilizzare
+     */
+    explicit SortedMap(const allocator_type &alloc): SortedMap(GEOMETRIC, alloc){
+
+    }
+
+    /**
+     * @brief Crea una mappa con le coppie della lista; tra chiavi equivalenti viene mantenuta la prima.
+     *
+     * @param pairs coppie (chiave, valore)
+     */
+    SortedMap(std::initializer_list<std::pair<K, V> > pairs): SortedMap(){
+        reserve(pairs.size());
+        for(const std::pair<K, V> &p : pairs){
+            try_emplace(p.first, p.second);
+        }
+    }
+
+    /**
+     * @brief Copy constructor
+     *
+     * @param other SortedMap da copiare
+     */
+    SortedMap(const SortedMap &other)
+        : SortedMap(other, key_traits::select_on_container_copy_construction(other._keyAlloc)) {
+
+    }
+
+    /**
+     * @brief Copy constructor con allocatore esplicito
+     *
+     * @param other SortedMap da copiare
+     * @param alloc allocatore da utilizzare per la copia
+     */
+    SortedMap(const SortedMap &other, const allocator_type &alloc)
+        : _keys(nullptr), _values(nullptr), _size(0), _capacity(0), _policy(other._policy), _cmp(other._cmp),
+          _keyAlloc(alloc), _valueAlloc(alloc) {
+
+        reserve(other._size);
+        try{
+            for(; _size < other._size; ++_size){
+                key_traits::construct(_keyAlloc, _keys + _size, other._keys[_size]);
+                try{
+                    value_traits::construct(_valueAlloc, _values + _size, other._values[_size]);
+                } catch(...){
+                    key_traits::destroy(_keyAlloc, _keys + _size);
+                    throw;
+                }
+                SORTEDARRAY_COUNT(copies, 1);
+            }
+        } catch(...){
+            release();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Move constructor: acquisisce i buffer di other, che rimane vuota.
+     *
+     * @param other SortedMap da spostare
+     */
+    SortedMap(SortedMap &&other) noexcept
+        : _keys(other._keys), _values(other._values), _size(other._size), _capacity(other._capacity),
+          _policy(other._policy), _cmp(std::move(other._cmp)),
+          _keyAlloc(std::move(other._keyAlloc)), _valueAlloc(std::move(other._valueAlloc)) {
+
+        other._keys = nullptr;
+        other._values = nullptr;
+        other._size = 0;
+        other._capacity = 0;
+    }
+
+    /**
+     * @brief Operatore assegnamento: la copia viene costruita prima di modificare this.
+     * L'allocatore di other viene adottato solo se l'allocatore lo prevede
+     * (propagate_on_container_copy_assignment).
+     *
+     * @param other SortedMap da copiare
+     * @return SortedMap& reference alla mappa this
+     */
+    SortedMap& operator=(const SortedMap &other){
+        if(this != &other){
+            SortedMap tmp(other, key_traits::propagate_on_container_copy_assignment::value ? other._keyAlloc : _keyAlloc);
+            swapStorage(tmp);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Operatore assegnamento per spostamento
+     * I buffer di other vengono acquisiti se gli allocatori sono intercambiabili, altrimenti
+     * le coppie vengono spostate una ad una nella memoria di this.
+     *
+     * @param other SortedMap da spostare, che rimane vuota
+     * @return SortedMap& reference alla mappa this
+     */
+    SortedMap& operator=(SortedMap &&other)
+        noexcept(key_traits::propagate_on_container_move_assignment::value || key_traits::is_always_equal::value) {
+
+        if(this != &other){
+            if(key_traits::propagate_on_container_move_assignment::value || _keyAlloc == other._keyAlloc){
+                release();
+                if constexpr(key_traits::propagate_on_container_move_assignment::value){
+                    _keyAlloc = std::move(other._keyAlloc);
+                    _valueAlloc = std::move(other._valueAlloc);
+                }
+                _keys = other._keys;
+                _values = other._values;
+                _size = other._size;
+                _capacity = other._capacity;
+                _policy = other._policy;
+                _cmp = std::move(other._cmp);
+
+                other._keys = nullptr;
+                other._values = nullptr;
+                other._size = 0;
+                other._capacity = 0;
+            } else {
+                SortedMap tmp(other._policy, _keyAlloc);
+                tmp.reserve(other._size);
+                for(; tmp._size < other._size; ++tmp._size){
+                    key_traits::construct(tmp._keyAlloc, tmp._keys + tmp._size, std::move(other._keys[tmp._size]));
+                    value_traits::construct(tmp._valueAlloc, tmp._values + tmp._size, std::move(other._values[tmp._size]));
+                }
+                tmp._cmp = std::move(other._cmp);
+                swapStorage(tmp);
+                other.release();
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Distruttore
+     *
+     */
+    ~SortedMap(){
+        release();
+    }
+
+    /**
+     * @brief Scambia il contenuto di this con quello di other in tempo costante.
+     * Gli allocatori vengono scambiati solo se l'allocatore lo prevede
+     * (propagate_on_container_swap), altrimenti devono essere uguali.
+     *
+     * @param other SortedMap da scambiare
+     */
+    void swap(SortedMap &other) noexcept {
+        key_storage::propagateSwap(_keyAlloc, other._keyAlloc);
+        value_storage::propagateSwap(_valueAlloc, other._valueAlloc);
+        swapContent(other);
+    }
+
+    /**
+     * @brief Ritorna il valore associato a key, inserendo un valore costruito di default
+     * se la chiave è assente.
+     *
+     * @param key chiave da cercare
+     * @return V& valore associato a key
+     */
+    V& operator[](const K &key){
+        return try_emplace(key).first.value();
+    }
+
+    /**
+     * @brief Come operator[](const K &), ma la chiave viene spostata nella mappa se assente.
+     *
+     * @param key chiave da cercare
+     * @return V& valore associato a key
+     */
+    V& operator[](K &&key){
+        return try_emplace(std::move(key)).first.value();
+    }
+
+    /**
+     * @brief Inserisce la chiave key con un valore costruito dagli argomenti dati,
+     * solo se la chiave è assente. Se la chiave è presente gli argomenti non vengono utilizzati.
+     *
+     * @tparam Args tipi degli argomenti del costruttore di V
+     * @param key chiave da inserire
+     * @param args argomenti del costruttore di V
+     * @return std::pair<iterator, bool> iteratore alla coppia con chiave key, e true se è stata inserita
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const K &key, Args&&... args){
+        return emplaceKey(key, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Come try_emplace(const K &, Args&&...), ma la chiave viene spostata nella mappa.
+     *
+     * @tparam Args tipi degli argomenti del costruttore di V
+     * @param key chiave da inserire
+     * @param args argomenti del costruttore di V
+     * @return std::pair<iterator, bool> iteratore alla coppia con chiave key, e true se è stata inserita
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K &&key, Args&&... args){
+        return emplaceKey(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Associa value alla chiave key: se la chiave è presente il valore viene assegnato,
+     * altrimenti la coppia viene inserita.
+     *
+     * @tparam M tipo del valore, assegnabile a V
+     * @param key chiave
+     * @param value valore da associare
+     * @return std::pair<iterator, bool> iteratore alla coppia con chiave key, e true se è stata inserita
+     */
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const K &key, M &&value){
+        std::pair<iterator, bool> result = emplaceKey(key, std::forward<M>(value));
+        if(!result.second){
+            result.first.value() = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Come insert_or_assign(const K &, M&&), ma la chiave viene spostata nella mappa se assente.
+     *
+     * @tparam M tipo del valore, assegnabile a V
+     * @param key chiave
+     * @param value valore da associare
+     * @return std::pair<iterator, bool> iteratore alla coppia con chiave key, e true se è stata inserita
+     */
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(K &&key, M &&value){
+        std::pair<iterator, bool> result = emplaceKey(std::move(key), std::forward<M>(value));
+        if(!result.second){
+            result.first.value() = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Ricerca binaria della coppia con chiave equivalente a key.
+     * Con un funtore trasparente key può essere di qualsiasi tipo confrontabile con K,
+     * altrimenti deve essere convertibile in K.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return iterator iteratore alla coppia trovata, o end() se assente
+     */
+    template<typename Q>
+    iterator find(const Q &key){
+        SORTEDARRAY_TIME(LOOKUP);
+        const lookup_type<Q> &k = key;
+        size_type pos = lowerIndex(k);
+        if(pos != _size && !compare(k, _keys[pos])){
+            return iterator(_keys + pos, _values + pos);
+        }
+        return end();
+    }
+
+    template<typename Q>
+    const_iterator find(const Q &key) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        const lookup_type<Q> &k = key;
+        size_type pos = lowerIndex(k);
+        if(pos != _size && !compare(k, _keys[pos])){
+            return const_iterator(_keys + pos, _values + pos);
+        }
+        return end();
+    }
+
+    /**
+     * @brief Ritorna true se la mappa contiene una chiave equivalente a key.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return true
+     * @return false
+     */
+    template<typename Q>
+    bool contains(const Q &key) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        const lookup_type<Q> &k = key;
+        size_type pos = lowerIndex(k);
+        return pos != _size && !compare(k, _keys[pos]);
+    }
+
+    /**
+     * @brief Numero di chiavi equivalenti a key (0 o 1).
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return size_type numero di chiavi equivalenti
+     */
+    template<typename Q>
+    size_type count(const Q &key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    /**
+     * @brief Prima coppia la cui chiave non precede key.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return iterator iteratore alla coppia, o end()
+     */
+    template<typename Q>
+    iterator lower_bound(const Q &key){
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type pos = lowerIndex(static_cast<const lookup_type<Q>&>(key));
+        return iterator(_keys + pos, _values + pos);
+    }
+
+    template<typename Q>
+    const_iterator lower_bound(const Q &key) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type pos = lowerIndex(static_cast<const lookup_type<Q>&>(key));
+        return const_iterator(_keys + pos, _values + pos);
+    }
+
+    /**
+     * @brief Prima coppia la cui chiave segue key.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return iterator iteratore alla coppia, o end()
+     */
+    template<typename Q>
+    iterator upper_bound(const Q &key){
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type pos = upperIndex(static_cast<const lookup_type<Q>&>(key));
+        return iterator(_keys + pos, _values + pos);
+    }
+
+    template<typename Q>
+    const_iterator upper_bound(const Q &key) const {
+        SORTEDARRAY_TIME(LOOKUP);
+        size_type pos = upperIndex(static_cast<const lookup_type<Q>&>(key));
+        return const_iterator(_keys + pos, _values + pos);
+    }
+
+    /**
+     * @brief Rimuove la coppia con chiave equivalente a key, se presente.
+     *
+     * @param key chiave da rimuovere
+     * @return size_type numero di coppie rimosse (0 o 1)
+     */
+    size_type erase(const K &key){
+        iterator it = find(key);
+        if(it == end()){
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    /**
+     * @brief Rimuove la coppia puntata dall'iteratore, spostando indietro le successive.
+     * Con la politica MINIMAL viene rilasciata anche la memoria in eccesso.
+     *
+     * @param pos iteratore alla coppia da rimuovere, diverso da end()
+     * @return iterator iteratore alla coppia successiva
+     */
+    iterator erase(iterator pos){
+        SORTEDARRAY_TIME(ERASE);
+        size_type index = pos._key - _keys;
+        assert(index >= 0 && index < _size);
+        key_traits::destroy(_keyAlloc, _keys + index);
+        value_traits::destroy(_valueAlloc, _values + index);
+        relocate(index + 1, _size - index - 1, index);
+        --_size;
+        if(_policy == MINIMAL){
+            shrink_to_fit();
+        }
+        return iterator(_keys + index, _values + index);
+    }
+
+    /**
+     * @brief Porta la capacità ad almeno n coppie.
+     *
+     * @param n capacità minima richiesta
+     */
+    void reserve(size_type n){
+        if(n > _capacity){
+            reallocate(n);
+        }
+    }
+
+    /**
+     * @brief Riduce la capacità al numero di coppie contenute.
+     *
+     */
+    void shrink_to_fit(){
+        if(_capacity > _size){
+            reallocate(_size);
+        }
+    }
+
+    /**
+     * @brief Svuota la mappa e rilascia la memoria.
+     *
+     */
+    void toEmpty(){
+        release();
+    }
+
+    /**
+     * @brief Getter del numero di coppie della mappa
+     *
+     * @return size_type numero di coppie
+     */
+    size_type size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Getter della capacità della mappa
+     *
+     * @return size_type capacità
+     */
+    size_type capacity() const {
+        return _capacity;
+    }
+
+    /**
+     * @brief Getter della politica di crescita della capacità
+     *
+     * @return growth_policy politica di crescita attuale
+     */
+    growth_policy policy() const {
+        return _policy;
+    }
+
+    /**
+     * @brief Imposta la politica di crescita della capacità.
+     * Passando a MINIMAL la capacità in eccesso viene rilasciata subito.
+     *
+     * @param policy nuova politica di crescita
+     */
+    void setPolicy(growth_policy policy){
+        _policy = policy;
+        if(_policy == MINIMAL){
+            shrink_to_fit();
+        }
+    }
+
+    /**
+     * @brief Statistiche raccolte dalla mappa, come SortedArray::stats().
+     * Se la macro SORTEDARRAY_STATS non è definita ritorna sempre statistiche vuote.
+     *
+     * @return const sorted_array_stats& statistiche della mappa
+     */
+    const sorted_array_stats& stats() const {
+#ifdef SORTEDARRAY_STATS
+        return _stats;
+#else
+        static const sorted_array_stats empty;
+        return empty;
+#endif
+    }
+
+    /**
+     * @brief Azzera le statistiche della mappa.
+     *
+     */
+    void resetStats(){
+#ifdef SORTEDARRAY_STATS
+        _stats.reset();
+#endif
+    }
+
+    /**
+     * @brief Getter dell'allocatore
+     *
+     * @return allocator_type copia dell'allocatore delle chiavi
+     */
+    allocator_type get_allocator() const {
+        return _keyAlloc;
+    }
+
+    /**
+     * @brief Ritorna un iteratore alla prima coppia.
+     *
+     * @return iterator
+     */
+    iterator begin(){
+        return iterator(_keys, _values);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(_keys, _values);
+    }
+
+    /**
+     * @brief Ritorna un iteratore alla fine della mappa.
+     *
+     * @return iterator
+     */
+    iterator end(){
+        return iterator(_keys + _size, _values + _size);
+    }
+
+    const_iterator end() const {
+        return const_iterator(_keys + _size, _values + _size);
+    }
+
+    /**
+     * @brief Operatore di stream per SortedMap: stampa le coppie in ordine di chiave.
+     *
+     * @param os
+     * @param map
+     * @return std::ostream&
+     */
+    friend std::ostream& operator<<(std::ostream &os, const SortedMap &map){
+        os << "Capacità: " << map.capacity() << std::endl;
+        os << "Coppie in ordine: ";
+        for(size_type i = 0; i < map._size; ++i){
+            os << "(" << map._keys[i] << ", " << map._values[i] << ") ";
+        }
+        os << std::endl;
+        return os;
+    }
+
+    private:
+
+    /**
+     * @brief Confronta due chiavi con il funtore, contando il confronto nelle statistiche.
+     *
+     * @param a prima chiave
+     * @param b seconda chiave
+     * @return true se a precede b
+     */
+    template<typename A, typename B>
+    bool compare(const A &a, const B &b) const {
+        SORTEDARRAY_COUNT(comparisons, 1);
+        return _cmp(a, b);
+    }
+
+    /**
+     * @brief Ricerca binaria della prima chiave che non precede key.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return size_type indice della prima chiave che non precede key, o _size
+     */
+    template<typename Q>
+    size_type lowerIndex(const Q &key) const {
+        size_type first = 0;
+        size_type count = _size;
+        while(count > 0){
+            size_type half = count / 2;
+            if(compare(_keys[first + half], key)){
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Ricerca binaria della prima chiave che segue key.
+     *
+     * @tparam Q tipo della chiave cercata
+     * @param key chiave da cercare
+     * @return size_type indice della prima chiave che segue key, o _size
+     */
+    template<typename Q>
+    size_type upperIndex(const Q &key) const {
+        size_type first = 0;
+        size_type count = _size;
+        while(count > 0){
+            size_type half = count / 2;
+            if(compare(key, _keys[first + half])){
+                count = half;
+            } else {
+                first += half + 1;
+                count -= half + 1;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Inserisce la coppia (key, V(args...)) se la chiave è assente.
+     *
+     * @tparam KK tipo della chiave (reference a K)
+     * @tparam Args tipi degli argomenti del costruttore di V
+     * @param key chiave da inserire
+     * @param args argomenti del costruttore di V
+     * @return std::pair<iterator, bool> iteratore alla coppia con chiave key, e true se è stata inserita
+     */
+    template<typename KK, typename... Args>
+    std::pair<iterator, bool> emplaceKey(KK &&key, Args&&... args){
+        SORTEDARRAY_TIME(INSERT);
+        size_type pos = lowerIndex(key);
+        if(pos != _size && !compare(key, _keys[pos])){
+            return std::pair<iterator, bool>(iterator(_keys + pos, _values + pos), false);
+        }
+        insertAt(pos, std::forward<KK>(key), std::forward<Args>(args)...);
+        return std::pair<iterator, bool>(iterator(_keys + pos, _values + pos), true);
+    }
+
+    /**
+     * @brief Inserisce una coppia nella posizione pos, spostando in avanti le successive.
+     * Chiave e valore vengono costruiti prima di spostare le coppie esistenti, per cui key e args
+     * possono riferirsi a elementi della mappa; se la costruzione fallisce la mappa rimane invariata.
+     *
+     * @tparam KK tipo della chiave (reference a K)
+     * @tparam Args tipi degli argomenti del costruttore di V
+     * @param pos posizione di inserimento, che deve rispettare l'ordinamento
+     * @param key chiave da inserire
+     * @param args argomenti del costruttore di V
+     */
+    template<typename KK, typename... Args>
+    void insertAt(size_type pos, KK &&key, Args&&... args){
+        K k(std::forward<KK>(key));
+        V v(std::forward<Args>(args)...);
+        if(_size == _capacity){
+            reallocate(grownCapacity(_policy, _capacity, _size + 1));
+        }
+
+        relocate(pos, _size - pos, pos + 1);
+        key_traits::construct(_keyAlloc, _keys + pos, std::move(k));
+        value_traits::construct(_valueAlloc, _values + pos, std::move(v));
+        ++_size;
+    }
+
+    /**
+     * @brief Sposta chiavi e valori in nuovi buffer di capacità newCapacity.
+     * Se un'allocazione fallisce la mappa rimane invariata.
+     *
+     * @param newCapacity nuova capacità, non inferiore a _size
+     */
+    void reallocate(size_type newCapacity){
+        assert(newCapacity >= _size);
+        SORTEDARRAY_COUNT(reallocations, 1);
+        K *keys = key_storage::allocate(_keyAlloc, newCapacity);
+        V *values;
+        try{
+            values = value_storage::allocate(_valueAlloc, newCapacity);
+        } catch(...){
+            key_storage::deallocate(_keyAlloc, keys, newCapacity);
+            throw;
+        }
+        if(newCapacity > 0){
+            SORTEDARRAY_COUNT(allocations, 2);
+            SORTEDARRAY_COUNT(bytes_allocated, newCapacity * (sizeof(K) + sizeof(V)));
+        }
+        SORTEDARRAY_COUNT(moves, _size);
+        key_storage::relocate(_keyAlloc, _keys, _size, keys);
+        value_storage::relocate(_valueAlloc, _values, _size, values);
+        deallocate();
+        _keys = keys;
+        _values = values;
+        _capacity = newCapacity;
+    }
+
+    /**
+     * @brief Sposta n coppie dalla posizione src alla posizione dst, distruggendo gli originali
+     * (vedi sorted_storage::relocate()). Gli intervalli possono sovrapporsi.
+     *
+     * @param src posizione della prima coppia da spostare
+     * @param n numero di coppie
+     * @param dst posizione di destinazione della prima coppia
+     */
+    void relocate(size_type src, size_type n, size_type dst) noexcept {
+        if(src != dst){
+            SORTEDARRAY_COUNT(moves, n);
+        }
+        key_storage::relocate(_keyAlloc, _keys + src, n, _keys + dst);
+        value_storage::relocate(_valueAlloc, _values + src, n, _values + dst);
+    }
+
+    /**
+     * @brief Scambia buffer e stato con other, senza toccare gli allocatori.
+     *
+     * @param other SortedMap da scambiare
+     */
+    void swapContent(SortedMap &other) noexcept {
+        std::swap(_keys, other._keys);
+        std::swap(_values, other._values);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_policy, other._policy);
+        std::swap(_cmp, other._cmp);
+    }
+
+    /**
+     * @brief Scambia buffer, stato e allocatori con other, indipendentemente dalla
+     * politica di propagazione dell'allocatore, come SortedArray::swapStorage():
+     * ogni buffer resta associato all'allocatore che lo ha allocato.
+     *
+     * @param other SortedMap da scambiare
+     */
+    void swapStorage(SortedMap &other) noexcept {
+        swapContent(other);
+        key_storage::swapAllocators(_keyAlloc, other._keyAlloc);
+        value_storage::swapAllocators(_valueAlloc, other._valueAlloc);
+    }
+
+    /**
+     * @brief Rilascia i buffer senza distruggere gli elementi.
+     *
+     */
+    void deallocate(){
+        key_storage::deallocate(_keyAlloc, _keys, _capacity);
+        value_storage::deallocate(_valueAlloc, _values, _capacity);
+    }
+
+    /**
+     * @brief Distrugge tutte le coppie e rilascia la memoria, lasciando la mappa vuota.
+     *
+     */
+    void release(){
+        key_storage::destroy(_keyAlloc, _keys, _keys + _size);
+        value_storage::destroy(_valueAlloc, _values, _values + _size);
+        deallocate();
+        _keys = nullptr;
+        _values = nullptr;
+        _size = 0;
+        _capacity = 0;
+    }
+
+    K *_keys;
+    V *_values;
+    size_type _size;
+    size_type _capacity;
+    growth_policy _policy;
+    key_compare _cmp;
+    allocator_type _keyAlloc;
+    value_allocator _valueAlloc;
+#ifdef SORTEDARRAY_STATS
+    mutable sorted_array_stats _stats;
+#endif
+
+};
+
+#endif
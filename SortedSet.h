@@ -0,0 +1,375 @@
+#ifndef SortedSet_H
+#define SortedSet_H
+#include "SortedArray.h"
+
+/**
+ * @brief Insieme ordinato basato su SortedArray.
+ *
+ * Contiene al più un elemento per ogni classe di equivalenza del funtore C: due elementi a e b
+ * sono equivalenti se né C(a, b) né C(b, a) sono veri. Gli elementi sono memorizzati in un
+ * SortedArray, con la stessa gestione della memoria e gli stessi iteratori; insert() verifica
+ * la presenza dell'elemento con la stessa ricerca binaria che ne trova la posizione.
+ *
+ * @tparam T Tipo di dato all'interno dell'insieme
+ * @tparam C Funtore di ordinamento
+ * @tparam Alloc Allocatore degli elementi
+ */
+template<typename T, typename C, typename Alloc = std::allocator<T> >
+class SortedSet{
+
+    typedef SortedArray<T, C, Alloc> array_type;
+
+    public:
+
+    typedef typename array_type::size_type size_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::comparison comparison;
+    typedef typename array_type::allocator_type allocator_type;
+    typedef typename array_type::growth_policy growth_policy;
+    typedef typename array_type::iterator iterator;
+
+    /**
+     * @brief Costruttore di default: crea un insieme vuoto.
+     *
+     * @param policy politica di crescita della capacità
+     * @param alloc allocatore da utilizzare
+     */
+    SortedSet(growth_policy policy = array_type::GEOMETRIC, const allocator_type &alloc = allocator_type())
+        : _elements(policy, alloc) {
+
+    }
+
+    /**
+     * @brief Crea un insieme vuoto che utilizza l'allocatore dato.
+     *
+     * @param alloc allocatore da utilizzare
+     */
+    explicit SortedSet(const allocator_type &alloc): _elements(alloc){
+
+    }
+
+    /**
+     * @brief Crea un insieme con gli elementi della sequenza [first, last),
+     * scartando quelli equivalenti ad un elemento precedente della sequenza.
+     *
+     * @tparam Iter tipo degli iteratori
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     * @param alloc allocatore da utilizzare
+     */
+    template<typename Iter>
+    SortedSet(Iter first, Iter last, const allocator_type &alloc = allocator_type()): _elements(alloc){
+        insert(first, last);
+    }
+
+    /**
+     * @brief Crea un insieme con gli elementi della lista, scartando i duplicati.
+     *
+     * @param elements elementi dell'insieme
+     */
+    SortedSet(std::initializer_list<value_type> elements): _elements(){
+        insert(elements.begin(), elements.end());
+    }
+
+    /**
+     * @brief Inserisce una copia di element se l'insieme non contiene un elemento equivalente.
+     *
+     * @param element elemento da inserire
+     * @return std::pair<iterator, bool> iteratore all'elemento inserito o a quello equivalente
+     * già presente, e true se l'elemento è stato inserito
+     */
+    std::pair<iterator, bool> insert(const value_type &element){
+        return _elements.insert_unique(element);
+    }
+
+    /**
+     * @brief Come insert(const value_type &), ma l'elemento viene spostato invece che copiato.
+     *
+     * @param element elemento da inserire
+     * @return std::pair<iterator, bool> iteratore all'elemento inserito o a quello equivalente
+     * già presente, e true se l'elemento è stato inserito
+     */
+    std::pair<iterator, bool> insert(value_type &&element){
+        return _elements.insert_unique(std::move(element));
+    }
+
+    /**
+     * @brief Costruisce un elemento a partire dagli argomenti dati e lo inserisce
+     * se l'insieme non contiene un elemento equivalente.
+     *
+     * @tparam Args tipi degli argomenti del costruttore di T
+     * @param args argomenti del costruttore di T
+     * @return std::pair<iterator, bool> iteratore all'elemento inserito o a quello equivalente
+     * già presente, e true se l'elemento è stato inserito
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args){
+        return _elements.insert_unique(value_type(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Inserisce gli elementi della sequenza [first, last) che non hanno un equivalente
+     * nell'insieme o in una posizione precedente della sequenza. La sequenza viene fusa con
+     * SortedArray::insert() e i duplicati vengono poi compattati con un solo passaggio lineare.
+     *
+     * @tparam Iter tipo degli iteratori
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     * @return size_type numero di elementi inseriti
+     */
+    template<typename Iter>
+    size_type insert(Iter first, Iter last){
+        size_type before = _elements.size();
+        _elements.insert(first, last);
+        _elements.unique();
+        return _elements.size() - before;
+    }
+
+    /**
+     * @brief Inserisce gli elementi della lista, con le stesse modalità di insert(first, last).
+     *
+     * @param elements elementi da inserire
+     * @return size_type numero di elementi inseriti
+     */
+    size_type insert(std::initializer_list<value_type> elements){
+        return insert(elements.begin(), elements.end());
+    }
+
+    /**
+     * @brief Rimuove l'elemento equivalente ad element, se presente.
+     *
+     * @param element elemento da rimuovere
+     * @return size_type numero di elementi rimossi (0 o 1)
+     */
+    size_type erase(const value_type &element){
+        iterator it = _elements.find(element);
+        if(it == _elements.end()){
+            return 0;
+        }
+        _elements.erase(it);
+        return 1;
+    }
+
+    /**
+     * @brief Rimuove l'elemento puntato dall'iteratore.
+     *
+     * @param pos iteratore all'elemento da rimuovere, diverso da end()
+     * @return iterator iteratore all'elemento successivo a quello rimosso
+     */
+    iterator erase(iterator pos){
+        return _elements.erase(pos);
+    }
+
+    /**
+     * @brief Rimuove gli elementi nell'intervallo [first, last).
+     *
+     * @param first iteratore al primo elemento da rimuovere
+     * @param last iteratore successivo all'ultimo elemento da rimuovere
+     * @return iterator iteratore all'elemento che seguiva l'ultimo rimosso
+     */
+    iterator erase(iterator first, iterator last){
+        return _elements.erase(first, last);
+    }
+
+    /**
+     * @brief Rimuove gli elementi che soddisfano la condizione F.
+     *
+     * @tparam F
+     * @param parameter
+     * @return size_type numero di elementi rimossi
+     */
+    template<typename F>
+    size_type filter(F parameter){
+        return _elements.filter(parameter);
+    }
+
+    /**
+     * @brief Ricerca binaria dell'elemento equivalente ad element.
+     *
+     * @param element elemento da cercare
+     * @return iterator iteratore all'elemento trovato, o end() se assente
+     */
+    iterator find(const value_type &element){
+        return _elements.find(element);
+    }
+
+    /**
+     * @brief Ritorna true se l'insieme contiene un elemento equivalente ad element.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool contains(const value_type &element) const {
+        return _elements.count(element) != 0;
+    }
+
+    /**
+     * @brief Numero di elementi equivalenti ad element (0 o 1).
+     *
+     * @param element elemento da cercare
+     * @return size_type numero di elementi equivalenti
+     */
+    size_type count(const value_type &element) const {
+        return _elements.count(element);
+    }
+
+    /**
+     * @brief Primo elemento che non precede element.
+     *
+     * @param element elemento da cercare
+     * @return iterator iteratore al primo elemento non minore di element, o end()
+     */
+    iterator lower_bound(const value_type &element){
+        return _elements.lower_bound(element);
+    }
+
+    /**
+     * @brief Primo elemento che segue element.
+     *
+     * @param element elemento da cercare
+     * @return iterator iteratore al primo elemento maggiore di element, o end()
+     */
+    iterator upper_bound(const value_type &element){
+        return _elements.upper_bound(element);
+    }
+
+    /**
+     * @brief Unione di this e other in tempo lineare.
+     *
+     * @param other insieme da unire
+     * @return SortedSet elementi presenti in this o in other
+     */
+    SortedSet set_union(const SortedSet &other) const {
+        return SortedSet(_elements.set_union(other._elements));
+    }
+
+    /**
+     * @brief Intersezione di this e other in tempo lineare.
+     *
+     * @param other insieme da intersecare
+     * @return SortedSet elementi presenti sia in this che in other
+     */
+    SortedSet set_intersection(const SortedSet &other) const {
+        return SortedSet(_elements.set_intersection(other._elements));
+    }
+
+    /**
+     * @brief Differenza tra this e other in tempo lineare.
+     *
+     * @param other insieme degli elementi da escludere
+     * @return SortedSet elementi di this non presenti in other
+     */
+    SortedSet set_difference(const SortedSet &other) const {
+        return SortedSet(_elements.set_difference(other._elements));
+    }
+
+    /**
+     * @brief Ritorna true se ogni elemento di other è presente in this.
+     *
+     * @param other insieme da verificare
+     * @return true
+     * @return false
+     */
+    bool includes(const SortedSet &other) const {
+        return _elements.includes(other._elements);
+    }
+
+    /**
+     * @brief Porta la capacità ad almeno n elementi.
+     *
+     * @param n capacità minima richiesta
+     */
+    void reserve(size_type n){
+        _elements.reserve(n);
+    }
+
+    /**
+     * @brief Riduce la capacità al numero di elementi contenuti.
+     *
+     */
+    void shrink_to_fit(){
+        _elements.shrink_to_fit();
+    }
+
+    /**
+     * @brief Svuota l'insieme.
+     *
+     */
+    void toEmpty(){
+        _elements.toEmpty();
+    }
+
+    /**
+     * @brief Getter del numero di elementi dell'insieme
+     *
+     * @return size_type Numero di elementi
+     */
+    size_type size() const {
+        return _elements.size();
+    }
+
+    /**
+     * @brief Getter della capacità
+     *
+     * @return size_type Capacità dell'insieme
+     */
+    size_type capacity() const {
+        return _elements.capacity();
+    }
+
+    /**
+     * @brief Getter dell'allocatore
+     *
+     * @return allocator_type copia dell'allocatore utilizzato
+     */
+    allocator_type get_allocator() const {
+        return _elements.get_allocator();
+    }
+
+    /**
+     * @brief Ritorna un iteratore che punta al primo elemento.
+     * Se il dato viene modificato, non deve cambiare la sua posizione nell'ordinamento.
+     *
+     * @return iterator
+     */
+    iterator begin(){
+        return _elements.begin();
+    }
+
+    /**
+     * @brief Ritorna un iteratore che punta alla fine dell'insieme.
+     *
+     * @return iterator
+     */
+    iterator end(){
+        return _elements.end();
+    }
+
+    /**
+     * @brief Operatore di stream per SortedSet.
+     *
+     * @param os
+     * @param set
+     * @return std::ostream&
+     */
+    friend std::ostream& operator<<(std::ostream &os, const SortedSet &set){
+        return os << set._elements;
+    }
+
+    private:
+
+    /**
+     * @brief Crea un insieme dagli elementi di un SortedArray, che non deve contenere duplicati.
+     *
+     * @param elements elementi dell'insieme
+     */
+    explicit SortedSet(array_type &&elements): _elements(std::move(elements)){
+
+    }
+
+    array_type _elements;
+
+};
+
+#endif
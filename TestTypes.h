@@ -0,0 +1,150 @@
+#ifndef TestTypes_H
+#define TestTypes_H
+#include <iostream>
+#include "SortedArraySimd.h"
+
+/**
+ * @brief Funtore di confronto tra interi: utilizzato per stabilire un ordine crescente
+ * all'interno di un SortedArray.
+ * 
+ */
+struct int_crescent {
+  bool operator()(int a, int b) const {
+    return a<b;
+  }
+};
+
+/**
+ * @brief Funtore di confronto tra interi: utilizzato per stabilire un ordine decrescente
+ * all'interno di un SortedArray.
+ * 
+ */
+struct int_decrescent {
+  bool operator()(int a, int b) const {
+    return a>b;
+  }
+};
+
+/**
+ * @brief int_crescent e int_decrescent confrontano con < e >: le ricerche sui SortedArray
+ * di int che li usano possono essere vettorializzate.
+ * 
+ */
+template<>
+struct comparator_traits<int_crescent> {
+  static const int order = 1;
+  typedef int value_type;
+};
+
+template<>
+struct comparator_traits<int_decrescent> {
+  static const int order = -1;
+  typedef int value_type;
+};
+
+/**
+  @brief Funtore predicato 
+
+  Ritorna true se il valore intero passato è pari 
+*/
+struct is_even {
+  bool operator()(int a) const {
+    return (a % 2 ==0);
+  }
+};
+
+
+/**
+ * @brief Tipo Custom contenente una coppia chiave-valore.
+ * Utilizzata per il test su tipi custom.
+ * 
+ */
+struct keyValuePair{
+
+  keyValuePair(int k, char v): key(k), value(v) {};
+  keyValuePair(): key(0), value('0'){};
+
+/**
+ * @brief Operatore maggiore.
+ * Confronta la chiave di due keyValuePair e ritorna true se la chiave di *this è maggiore.
+ * 
+ * @param other 
+ * @return true 
+ * @return false 
+ */
+  bool operator>(keyValuePair &other){
+    return key > other.key;
+  }
+
+/**
+ * @brief Operatore minore.
+ * Confronta la chiave di due keyValuePair e ritorna true se la chiave di *this è minore.
+ * 
+ * @param other 
+ * @return true 
+ * @return false 
+ */
+  bool operator<(keyValuePair &other){
+    return key < other.key;
+  }
+
+/**
+ * @brief Operatore uguale.
+ * Confronta le variabili key e value di due keyValuePair, e ritorna true
+ * se combaciano.
+ * 
+ * @param other 
+ * @return true 
+ * @return false 
+ */
+  bool operator==(keyValuePair other){
+    if(key == other.key && value == other.value){
+      return true;
+    }
+    return false;
+  }
+
+  public:
+    int key;
+    char value;
+    
+
+};
+
+/**
+ * @brief Operatore di stream per keyValuePair.
+ * Stampa a video i valori di key e value.
+ * 
+ * @param os 
+ * @param kvp 
+ * @return std::ostream& 
+ */
+inline std::ostream& operator<<(std::ostream& os, const keyValuePair& kvp) {
+    os << "Key: " << kvp.key << ", Value: " << kvp.value;
+    return os;
+}
+
+/**
+ * @brief Funtore di confronto tra oggetti di tipo keyValuePair.
+ * Effettua il confronto utilizzando l'operatore > della struct.
+ * È trasparente: confronta anche un keyValuePair con una chiave intera,
+ * per cui le ricerche possono essere eseguite per chiave.
+ * 
+ */
+struct kv_crescent{
+  typedef void is_transparent;
+
+  bool operator()(keyValuePair a, keyValuePair b) const {
+    return a > b;
+  }
+
+  bool operator()(const keyValuePair &a, int key) const {
+    return a.key > key;
+  }
+
+  bool operator()(int key, const keyValuePair &b) const {
+    return key > b.key;
+  }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,727 @@
+#ifndef TieredSortedArray_H
+#define TieredSortedArray_H
+#include "SortedArray.h"
+#include <vector>
+
+/**
+ * @brief Array ordinato memorizzato come tiered vector: la sequenza è divisa in blocchi
+ * di B elementi (B potenza di 2), ognuno gestito come buffer circolare.
+ *
+ * Tutti i blocchi tranne l'ultimo occupato sono pieni, per cui l'elemento i si trova nel blocco
+ * i / B e vi si accede in O(1). Per inserire un elemento nel blocco k gli elementi del blocco
+ * vengono spostati verso il lato più vicino (al più B / 2 spostamenti) e ognuno dei blocchi
+ * successivi cede l'ultimo elemento al seguente, come primo elemento: nel buffer circolare
+ * è un solo spostamento per blocco. La rimozione procede in senso inverso. Con B mantenuto
+ * tra sqrt(n / 2) e 2 sqrt(n) (i blocchi vengono raddoppiati quando diventano troppi)
+ * push() e remove() spostano O(sqrt(n)) elementi invece degli O(n) di SortedArray,
+ * mentre la ricerca binaria e l'iteratore random access restano quelli di un array.
+ *
+ * Tra elementi equivalenti l'ordine è quello di inserimento, come in SortedArray.
+ * Per scegliere la memoria di un array ordinato con un parametro template vedi sorted_sequence.
+ *
+ * @tparam T Tipo di dato all'interno dell'array
+ * @tparam C Funtore di ordinamento
+ * @tparam Alloc Allocatore degli elementi
+ */
+template<typename T, typename C, typename Alloc = std::allocator<T> >
+class TieredSortedArray{
+
+    typedef std::allocator_traits<Alloc> alloc_traits;
+
+    public:
+
+    typedef int size_type;
+    typedef T value_type;
+    typedef C comparison;
+    typedef Alloc allocator_type;
+
+    /**
+     * @brief Iteratore random access: contiene la posizione dell'elemento, convertita
+     * in blocco e cella ad ogni accesso.
+     *
+     */
+    class iterator {
+
+        public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+
+        iterator(): _owner(nullptr), _index(0) {}
+
+        reference operator*() const {
+            return _owner->at(_index);
+        }
+
+        pointer operator->() const {
+            return &_owner->at(_index);
+        }
+
+        reference operator[](difference_type offset) const {
+            return _owner->at(_index + offset);
+        }
+
+        iterator& operator++() {
+            ++_index;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old(*this);
+            ++_index;
+            return old;
+        }
+
+        iterator& operator--() {
+            --_index;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator old(*this);
+            --_index;
+            return old;
+        }
+
+        iterator& operator+=(difference_type offset) {
+            _index += offset;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type offset) {
+            _index -= offset;
+            return *this;
+        }
+
+        iterator operator+(difference_type offset) const {
+            return iterator(_owner, _index + offset);
+        }
+
+        iterator operator-(difference_type offset) const {
+            return iterator(_owner, _index - offset);
+        }
+
+        difference_type operator-(const iterator &other) const {
+            return static_cast<difference_type>(_index) - other._index;
+        }
+
+        bool operator==(const iterator &other) const {
+            return _index == other._index && _owner == other._owner;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+
+        bool operator<(const iterator &other) const {
+            return _index < other._index;
+        }
+
+        bool operator>(const iterator &other) const {
+            return _index > other._index;
+        }
+
+        bool operator<=(const iterator &other) const {
+            return _index <= other._index;
+        }
+
+        bool operator>=(const iterator &other) const {
+            return _index >= other._index;
+        }
+
+        private:
+
+        friend class TieredSortedArray;
+
+        iterator(TieredSortedArray *owner, size_type index): _owner(owner), _index(index) {}
+
+        TieredSortedArray *_owner;
+        size_type _index;
+    };
+
+    /**
+     * @brief Crea un array vuoto.
+     *
+     * @param alloc allocatore da utilizzare
+     */
+    explicit TieredSortedArray(const allocator_type &alloc = allocator_type())
+        : _size(0), _shift(MIN_SHIFT), _alloc(alloc) {
+
+    }
+
+    /**
+     * @brief Crea un array con gli elementi della sequenza [first, last), ordinati
+     * con un SortedArray e poi distribuiti nei blocchi.
+     *
+     * @tparam Iter tipo degli iteratori
+     * @param first iteratore di inizio
+     * @param last iteratore di fine
+     * @param alloc allocatore da utilizzare
+     */
+    template<typename Iter>
+    TieredSortedArray(Iter first, Iter last, const allocator_type &alloc = allocator_type())
+        : TieredSortedArray(alloc) {
+        SortedArray<T, C, Alloc> sorted(alloc);
+        sorted.insert(first, last);
+        try{
+            for(value_type &x : sorted){
+                append(std::move(x));
+            }
+        } catch(...){
+            toEmpty();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Copy constructor.
+     *
+     * @param other array da copiare
+     */
+    TieredSortedArray(const TieredSortedArray &other)
+        : TieredSortedArray(alloc_traits::select_on_container_copy_construction(other._alloc)) {
+        _cmp = other._cmp;
+        try{
+            for(size_type i = 0; i < other._size; ++i){
+                append(value_type(other.at(i)));
+            }
+        } catch(...){
+            toEmpty();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Move constructor: sposta i blocchi di other, che rimane vuoto.
+     *
+     * @param other array da spostare
+     */
+    TieredSortedArray(TieredSortedArray &&other) noexcept
+        : _blocks(std::move(other._blocks)), _size(other._size), _shift(other._shift), _cmp(other._cmp), _alloc(other._alloc) {
+        other._blocks.clear();
+        other._size = 0;
+        other._shift = MIN_SHIFT;
+    }
+
+    /**
+     * @brief Assegnamento per copia e per spostamento.
+     *
+     * @param other array da assegnare
+     * @return TieredSortedArray&
+     */
+    TieredSortedArray& operator=(TieredSortedArray other){
+        std::swap(_blocks, other._blocks);
+        std::swap(_size, other._size);
+        std::swap(_shift, other._shift);
+        std::swap(_cmp, other._cmp);
+        if constexpr(std::is_swappable<allocator_type>::value){
+            std::swap(_alloc, other._alloc);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Distruttore
+     *
+     */
+    ~TieredSortedArray(){
+        toEmpty();
+    }
+
+    /**
+     * @brief Inserisce una copia di element dopo gli elementi equivalenti.
+     *
+     * @param element elemento da inserire
+     */
+    void push(const value_type &element){
+        insertAt(upperIndex(element), value_type(element));
+    }
+
+    /**
+     * @brief Come push(const value_type &), ma l'elemento viene spostato.
+     *
+     * @param element elemento da inserire
+     */
+    void push(value_type &&element){
+        size_type pos = upperIndex(element);
+        insertAt(pos, std::move(element));
+    }
+
+    /**
+     * @brief Rimuove il primo elemento uguale ad element, se presente.
+     *
+     * @param element elemento da rimuovere
+     */
+    void remove(const value_type &element){
+        size_type index = indexOf(element);
+        if(index != _size){
+            eraseAt(index);
+        }
+    }
+
+    /**
+     * @brief Rimuove l'elemento puntato dall'iteratore.
+     *
+     * @param pos iteratore all'elemento da rimuovere, diverso da end()
+     * @return iterator iteratore all'elemento successivo a quello rimosso
+     */
+    iterator erase(iterator pos){
+        eraseAt(pos._index);
+        return iterator(this, pos._index);
+    }
+
+    /**
+     * @brief Ritorna true se un elemento uguale ad element (operatore ==) è presente.
+     *
+     * @param element elemento da cercare
+     * @return true
+     * @return false
+     */
+    bool encountered(const value_type &element) const {
+        return indexOf(element) != _size;
+    }
+
+    /**
+     * @brief Rimuove gli elementi che soddisfano la condizione F con un solo passaggio,
+     * compattando i rimanenti e rilasciando i blocchi non più utilizzati.
+     *
+     * @tparam F
+     * @param parameter
+     * @return size_type numero di elementi rimossi
+     */
+    template<typename F>
+    size_type filter(F parameter){
+        size_type slot = 0;
+        for(size_type i = 0; i < _size; ++i){
+            if(!parameter(at(i))){
+                if(slot != i){
+                    at(slot) = std::move(at(i));
+                }
+                ++slot;
+            }
+        }
+        size_type removed = _size - slot;
+        while(_size > slot){
+            popBack();
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Primo elemento che non precede element.
+     *
+     * @param element elemento da cercare
+     * @return iterator
+     */
+    iterator lower_bound(const value_type &element){
+        return iterator(this, lowerIndex(element));
+    }
+
+    /**
+     * @brief Primo elemento che segue element.
+     *
+     * @param element elemento da cercare
+     * @return iterator
+     */
+    iterator upper_bound(const value_type &element){
+        return iterator(this, upperIndex(element));
+    }
+
+    /**
+     * @brief Primo elemento equivalente ad element.
+     *
+     * @param element elemento da cercare
+     * @return iterator iteratore all'elemento trovato, o end() se assente
+     */
+    iterator find(const value_type &element){
+        size_type index = lowerIndex(element);
+        if(index != _size && !_cmp(element, at(index))){
+            return iterator(this, index);
+        }
+        return end();
+    }
+
+    /**
+     * @brief Numero di elementi equivalenti ad element.
+     *
+     * @param element elemento da cercare
+     * @return size_type
+     */
+    size_type count(const value_type &element) const {
+        return upperIndex(element) - lowerIndex(element);
+    }
+
+    /**
+     * @brief Svuota l'array e rilascia i blocchi.
+     *
+     */
+    void toEmpty(){
+        while(_size > 0){
+            popBack();
+        }
+        for(block &b : _blocks){
+            alloc_traits::deallocate(_alloc, b.data, blockSize());
+        }
+        _blocks.clear();
+        _shift = MIN_SHIFT;
+    }
+
+    /**
+     * @brief Getter del numero di elementi
+     *
+     * @return size_type
+     */
+    size_type size() const {
+        return _size;
+    }
+
+    /**
+     * @brief Dimensione attuale dei blocchi.
+     *
+     * @return size_type
+     */
+    size_type blockSize() const {
+        return size_type(1) << _shift;
+    }
+
+    /**
+     * @brief Ritorna un iteratore che punta al primo elemento.
+     *
+     * @return iterator
+     */
+    iterator begin(){
+        return iterator(this, 0);
+    }
+
+    /**
+     * @brief Ritorna un iteratore che punta alla fine dell'array.
+     *
+     * @return iterator
+     */
+    iterator end(){
+        return iterator(this, _size);
+    }
+
+    /**
+     * @brief Operatore di stream per TieredSortedArray.
+     *
+     * @param os
+     * @param arr
+     * @return std::ostream&
+     */
+    friend std::ostream& operator<<(std::ostream &os, const TieredSortedArray &arr){
+        os << "Blocchi: " << arr._blocks.size() << " da " << arr.blockSize() << std::endl;
+        os << "Elementi in ordine: ";
+        for(size_type i = 0; i < arr._size; ++i){
+            os << arr.at(i) << " ";
+        }
+        os << std::endl;
+        return os;
+    }
+
+    private:
+
+    /**
+     * @brief Blocchi iniziali di 64 elementi.
+     *
+     */
+    static const int MIN_SHIFT = 6;
+
+    /**
+     * @brief Blocco: buffer circolare di blockSize() celle, il cui primo elemento è in head.
+     *
+     */
+    struct block {
+        value_type *data;
+        size_type head;
+    };
+
+    size_type mask() const {
+        return blockSize() - 1;
+    }
+
+    /**
+     * @brief Cella j (dal primo elemento) del blocco k.
+     *
+     */
+    value_type* cell(size_type k, size_type j) const {
+        return _blocks[k].data + ((_blocks[k].head + j) & mask());
+    }
+
+    /**
+     * @brief Elemento in posizione i.
+     *
+     */
+    value_type& at(size_type i) const {
+        return *cell(i >> _shift, i & mask());
+    }
+
+    /**
+     * @brief Sposta l'elemento in src nella cella non inizializzata dst, distruggendo l'originale.
+     *
+     */
+    void moveCell(value_type *src, value_type *dst){
+        alloc_traits::construct(_alloc, dst, std::move(*src));
+        alloc_traits::destroy(_alloc, src);
+    }
+
+    /**
+     * @brief Numero di elementi del blocco k.
+     *
+     */
+    size_type blockCount(size_type k) const {
+        return std::min(blockSize(), _size - (k << _shift));
+    }
+
+    /**
+     * @brief Alloca un blocco vuoto in fondo.
+     *
+     */
+    void addBlock(){
+        value_type *data = alloc_traits::allocate(_alloc, blockSize());
+        try{
+            _blocks.push_back(block{data, 0});
+        } catch(...){
+            alloc_traits::deallocate(_alloc, data, blockSize());
+            throw;
+        }
+    }
+
+    /**
+     * @brief Inserisce element in posizione pos, dopo aver liberato una cella nel blocco
+     * di pos facendo scorrere di una posizione l'ultimo elemento dei blocchi successivi.
+     *
+     * @param pos posizione di inserimento
+     * @param element elemento da inserire
+     */
+    void insertAt(size_type pos, value_type &&element){
+        if(_size == static_cast<size_type>(_blocks.size()) << _shift){
+            if(static_cast<size_type>(_blocks.size()) >= 2 * blockSize()){
+                regroup(_shift + 1);
+            }
+            if(_size == static_cast<size_type>(_blocks.size()) << _shift){
+                addBlock();
+            }
+        }
+        size_type k = pos >> _shift;
+        size_type last = _size >> _shift;
+        size_type B = blockSize();
+        for(size_type m = last; m > k; --m){
+            // l'ultimo elemento del blocco m - 1, pieno, diventa il primo del blocco m
+            block &b = _blocks[m];
+            b.head = (b.head - 1) & mask();
+            moveCell(cell(m - 1, B - 1), b.data + b.head);
+        }
+
+        // nel blocco k gli elementi vengono spostati verso il lato più vicino
+        size_type count = k == last ? _size - (k << _shift) : B - 1;
+        size_type off = pos & mask();
+        block &b = _blocks[k];
+        if(off < count - off){
+            b.head = (b.head - 1) & mask();
+            for(size_type j = 0; j < off; ++j){
+                moveCell(cell(k, j + 1), cell(k, j));
+            }
+        } else {
+            for(size_type j = count; j > off; --j){
+                moveCell(cell(k, j - 1), cell(k, j));
+            }
+        }
+        alloc_traits::construct(_alloc, cell(k, off), std::move(element));
+        ++_size;
+    }
+
+    /**
+     * @brief Rimuove l'elemento in posizione pos, chiudendo il buco nel suo blocco e facendo
+     * scorrere indietro di una posizione il primo elemento dei blocchi successivi.
+     *
+     * @param pos posizione dell'elemento da rimuovere
+     */
+    void eraseAt(size_type pos){
+        size_type k = pos >> _shift;
+        size_type last = (_size - 1) >> _shift;
+        size_type count = blockCount(k);
+        size_type off = pos & mask();
+        block &b = _blocks[k];
+        alloc_traits::destroy(_alloc, cell(k, off));
+        if(off < count - 1 - off){
+            for(size_type j = off; j > 0; --j){
+                moveCell(cell(k, j - 1), cell(k, j));
+            }
+            b.head = (b.head + 1) & mask();
+        } else {
+            for(size_type j = off; j + 1 < count; ++j){
+                moveCell(cell(k, j + 1), cell(k, j));
+            }
+        }
+
+        size_type B = blockSize();
+        for(size_type m = k + 1; m <= last; ++m){
+            // il primo elemento del blocco m diventa l'ultimo del blocco m - 1
+            block &next = _blocks[m];
+            moveCell(next.data + next.head, cell(m - 1, B - 1));
+            next.head = (next.head + 1) & mask();
+        }
+        --_size;
+        releaseSpareBlocks();
+    }
+
+    /**
+     * @brief Rimuove l'ultimo elemento.
+     *
+     */
+    void popBack(){
+        alloc_traits::destroy(_alloc, &at(_size - 1));
+        --_size;
+        releaseSpareBlocks();
+    }
+
+    /**
+     * @brief Accoda element, che non deve precedere l'ultimo elemento.
+     *
+     */
+    void append(value_type &&element){
+        insertAt(_size, std::move(element));
+    }
+
+    /**
+     * @brief Rilascia i blocchi vuoti oltre il primo, che viene tenuto per evitare
+     * di allocarlo di nuovo all'inserimento successivo.
+     *
+     */
+    void releaseSpareBlocks(){
+        size_type used = (_size + blockSize() - 1) >> _shift;
+        while(static_cast<size_type>(_blocks.size()) > used + 1){
+            alloc_traits::deallocate(_alloc, _blocks.back().data, blockSize());
+            _blocks.pop_back();
+        }
+    }
+
+    /**
+     * @brief Ridistribuisce gli elementi in blocchi di 2^shift elementi, in O(n).
+     *
+     * @param shift nuovo logaritmo della dimensione dei blocchi
+     */
+    void regroup(int shift){
+        TieredSortedArray grouped(_alloc);
+        grouped._cmp = _cmp;
+        grouped._shift = shift;
+        grouped._blocks.reserve(((_size >> shift) + 2));
+        for(size_type i = 0; i < _size; ++i){
+            grouped.append(std::move(at(i)));
+        }
+        *this = std::move(grouped);
+    }
+
+    /**
+     * @brief Vale true se x precede element (Upper false) o se non lo segue (Upper true).
+     *
+     */
+    template<bool Upper, typename K>
+    bool before(const value_type &x, const K &element) const {
+        return Upper ? !_cmp(element, x) : _cmp(x, element);
+    }
+
+    /**
+     * @brief Ricerca in due passi: prima il blocco, confrontando element con l'ultimo elemento
+     * di ogni blocco, le cui intestazioni sono contigue, poi la posizione nel buffer circolare.
+     * Le ricerche binarie non contengono salti condizionati, come in sorted_array_simd.
+     *
+     * @return size_type prima posizione il cui elemento non precede element (Upper false)
+     * o lo segue (Upper true)
+     */
+    template<bool Upper, typename K>
+    size_type bound(const K &element) const {
+        if(_size == 0){
+            return 0;
+        }
+        size_type B = blockSize();
+        size_type used = ((_size - 1) >> _shift) + 1;
+        // il blocco cercato è in [k, k + len), l'ultimo viene scelto se tutti i precedenti precedono element
+        size_type k = 0;
+        size_type len = used;
+        while(len > 1){
+            size_type half = len / 2;
+            const block &b = _blocks[k + half - 1];
+            k += half * before<Upper>(b.data[(b.head + B - 1) & mask()], element);
+            len -= half;
+        }
+        const block &b = _blocks[k];
+        size_type base = 0;
+        len = blockCount(k);
+        // la posizione cercata è in [base, base + len]
+        while(len > 0){
+            size_type half = (len + 1) / 2;
+            base += half * before<Upper>(b.data[(b.head + base + half - 1) & mask()], element);
+            len -= half;
+        }
+        return (k << _shift) + base;
+    }
+
+    template<typename K>
+    size_type lowerIndex(const K &element) const {
+        return bound<false>(element);
+    }
+
+    template<typename K>
+    size_type upperIndex(const K &element) const {
+        return bound<true>(element);
+    }
+
+    /**
+     * @brief Indice del primo elemento uguale ad element tra quelli equivalenti, o _size.
+     *
+     */
+    size_type indexOf(const value_type &element) const {
+        for(size_type i = lowerIndex(element); i < _size && !_cmp(element, at(i)); ++i){
+            if(at(i) == element){
+                return i;
+            }
+        }
+        return _size;
+    }
+
+    std::vector<block> _blocks;
+    size_type _size;
+    int _shift;
+    C _cmp;
+    allocator_type _alloc;
+
+};
+
+/**
+ * @brief Politica di memoria per sorted_sequence: un solo array contiguo (SortedArray).
+ *
+ */
+struct flat_storage {
+    template<typename T, typename C, typename Alloc>
+    using container = SortedArray<T, C, Alloc>;
+};
+
+/**
+ * @brief Politica di memoria per sorted_sequence: blocchi di un tiered vector (TieredSortedArray).
+ *
+ */
+struct tiered_storage {
+    template<typename T, typename C, typename Alloc>
+    using container = TieredSortedArray<T, C, Alloc>;
+};
+
+/**
+ * @brief Array ordinato con la memoria scelta da una politica: flat_storage per
+ * ricerche e iterazioni più veloci, tiered_storage per inserimenti e rimozioni in O(sqrt(n)).
+ * Entrambi forniscono push(), remove(), encountered(), filter(), find(), lower_bound(),
+ * upper_bound(), count(), erase() e iteratori random access.
+ *
+ * @tparam T Tipo di dato all'interno dell'array
+ * @tparam C Funtore di ordinamento
+ * @tparam Storage flat_storage o tiered_storage
+ * @tparam Alloc Allocatore degli elementi
+ */
+template<typename T, typename C, typename Storage = flat_storage, typename Alloc = std::allocator<T> >
+using sorted_sequence = typename Storage::template container<T, C, Alloc>;
+
+#endif
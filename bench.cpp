@@ -0,0 +1,950 @@
+#include "SortedArray.h"
+#include "SortedMap.h"
+#include "EytzingerIndex.h"
+#include "ParallelBuild.h"
+#include "ConcurrentSortedArray.h"
+#include "LogSortedArray.h"
+#include "TieredSortedArray.h"
+#include "MappedSortedArray.h"
+#include "SortedArraySerialization.h"
+#include "CompressedSortedIntArray.h"
+#include "Allocators.h"
+#include "TestTypes.h"
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <random>
+
+/**
+ * @brief Risultato di un singolo caso di benchmark.
+ *
+ */
+struct result {
+  std::string name;
+  std::string payload;
+  std::string input;
+  long n;
+  long iterations;
+  double nsPerOp;
+  double comparisonsPerOp;
+};
+
+/**
+ * @brief Opzioni da riga di comando.
+ *
+ */
+struct options {
+  std::string format;
+  std::string filter;
+  long maxSize;
+  double minTimeNs;
+};
+
+static options opts = {"csv", "", 10000000, 5e7};
+static std::vector<result> results;
+
+/**
+ * @brief Destinazione dei valori calcolati nelle sezioni misurate,
+ * per evitare che il compilatore le elimini.
+ *
+ */
+static volatile long sink = 0;
+
+/**
+ * @brief Contatore globale delle chiamate al funtore di confronto.
+ *
+ */
+static unsigned long long comparisons = 0;
+
+/**
+ * @brief Funtore di confronto tra interi in ordine crescente che conta le proprie invocazioni.
+ *
+ */
+struct counting_crescent {
+  bool operator()(int a, int b) const {
+    ++comparisons;
+    return a<b;
+  }
+};
+
+/**
+ * @brief Funtore che inverte l'ordine indotto da C.
+ * Utilizzato per misurare il costruttore secondario tra SortedArray con ordinamenti diversi.
+ *
+ */
+template<typename C>
+struct reversed {
+  template<typename V>
+  bool operator()(const V &a, const V &b) const {
+    return C()(b, a);
+  }
+};
+
+/**
+ * @brief Predicato di filter(): ritorna true per le chiavi pari.
+ *
+ */
+struct even_key {
+  bool operator()(int a) const {
+    return a % 2 == 0;
+  }
+  bool operator()(const keyValuePair &a) const {
+    return a.key % 2 == 0;
+  }
+};
+
+/**
+ * @brief Tempo trascorso in nanosecondi da start.
+ *
+ * @param start istante iniziale
+ * @return double nanosecondi trascorsi
+ */
+double elapsedNs(std::chrono::steady_clock::time_point start){
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+/**
+ * @brief Ripete un caso di benchmark finché il tempo misurato non supera opts.minTimeNs.
+ * setup() viene eseguita fuori dalla misura, body() viene misurata e ritorna il numero
+ * di operazioni elementari eseguite.
+ *
+ * @tparam S tipo della funzione di preparazione
+ * @tparam B tipo della funzione misurata
+ * @param r risultato da completare con iterazioni e tempo per operazione
+ * @param setup funzione di preparazione
+ * @param body funzione misurata
+ * @return true se il caso è stato eseguito, false se escluso da --filter
+ */
+template<typename S, typename B>
+bool measure(result r, S setup, B body){
+  if(!opts.filter.empty() && r.name.find(opts.filter) == std::string::npos){
+    return false;
+  }
+
+  double total = 0;
+  long long ops = 0;
+  r.iterations = 0;
+  while(r.iterations == 0 || (total < opts.minTimeNs && r.iterations < 1000000)){
+    setup();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ops += body();
+    total += elapsedNs(start);
+    ++r.iterations;
+  }
+  r.nsPerOp = total / ops;
+  results.push_back(r);
+  return true;
+}
+
+/**
+ * @brief Chiave i-esima della sequenza di input richiesta.
+ *
+ * @param kind "sorted", "reverse", "random" o "duplicates"
+ * @param i posizione
+ * @param n lunghezza della sequenza
+ * @param gen generatore pseudo-casuale
+ * @return int chiave
+ */
+int makeKey(const std::string &kind, long i, long n, std::mt19937 &gen){
+  if(kind == "sorted") return i;
+  if(kind == "reverse") return n - i;
+  if(kind == "duplicates") return gen() % 16;
+  return gen() % 1000000000;
+}
+
+int makeElement(int key, int *){
+  return key;
+}
+
+keyValuePair makeElement(int key, keyValuePair *){
+  return keyValuePair(key, static_cast<char>('a' + key % 26));
+}
+
+/**
+ * @brief Genera n elementi di tipo P secondo il tipo di input richiesto.
+ *
+ * @tparam P tipo degli elementi
+ * @param n numero di elementi
+ * @param kind "sorted", "reverse", "random" o "duplicates"
+ * @param seed seme del generatore
+ * @return std::vector<P>
+ */
+template<typename P>
+std::vector<P> makeInput(long n, const std::string &kind, unsigned seed = 42){
+  std::mt19937 gen(seed);
+  std::vector<P> v;
+  v.reserve(n);
+  for(long i = 0; i < n; ++i){
+    v.push_back(makeElement(makeKey(kind, i, n, gen), static_cast<P*>(nullptr)));
+  }
+  return v;
+}
+
+/**
+ * @brief Esegue tutti i benchmark delle operazioni di SortedArray su un input.
+ * Per push, remove ed encountered viene misurato il costo di una singola operazione
+ * su un array di n elementi, ripetuta k volte; contains_many cerca le stesse k chiavi
+ * di encountered in una sola chiamata, e contains_many_sorted le cerca ordinate.
+ *
+ * @tparam P tipo degli elementi
+ * @tparam C funtore di ordinamento
+ * @param payload nome del tipo degli elementi
+ * @param kind tipo di input
+ * @param n numero di elementi
+ */
+template<typename P, typename C>
+void benchOperations(const char *payload, const std::string &kind, long n){
+  typedef SortedArray<P, C> array;
+
+  std::vector<P> input = makeInput<P>(n, kind);
+  std::vector<P> extra = makeInput<P>(n, kind == "duplicates" ? kind : "random", 7);
+  long k = std::min(n, std::max(10L, 100000000L / n));
+
+  array base(input.begin(), input.end());
+  array work;
+  result r = {"", payload, kind, n, 0, 0, -1};
+
+  r.name = "push";
+  measure(r, [&]{ work = base; }, [&]{
+    for(long i = 0; i < k; ++i){
+      work.push(extra[i]);
+    }
+    return k;
+  });
+
+  r.name = "remove";
+  measure(r, [&]{ work = base; }, [&]{
+    for(long i = 0; i < k; ++i){
+      work.remove(input[i]);
+    }
+    return k;
+  });
+
+  r.name = "encountered";
+  measure(r, []{}, [&]{
+    long found = 0;
+    for(long i = 0; i < k; ++i){
+      found += base.encountered(extra[i]);
+    }
+    sink = found;
+    return k;
+  });
+
+  std::vector<char> found(k);
+  r.name = "contains_many";
+  measure(r, []{}, [&]{
+    base.contains_many(extra.begin(), extra.begin() + k, found.begin());
+    sink = found[k - 1];
+    return k;
+  });
+
+  std::vector<P> probes(extra.begin(), extra.begin() + k);
+  std::sort(probes.begin(), probes.end(), C());
+  r.name = "contains_many_sorted";
+  measure(r, []{}, [&]{
+    base.contains_many(probes.begin(), probes.end(), found.begin());
+    sink = found[k - 1];
+    return k;
+  });
+
+  r.name = "filter";
+  measure(r, [&]{ work = base; }, [&]{
+    sink = work.filter(even_key());
+    return n;
+  });
+
+  r.name = "iterator_constructor";
+  measure(r, []{}, [&]{
+    array arr(input.begin(), input.end());
+    sink = arr.size();
+    return n;
+  });
+
+  r.name = "converting_constructor";
+  measure(r, []{}, [&]{
+    SortedArray<P, reversed<C> > arr(base);
+    sink = arr.size();
+    return n;
+  });
+
+  array other(extra.begin(), extra.end());
+
+  r.name = "merge";
+  measure(r, []{}, [&]{
+    array arr = base.merge(other);
+    sink = arr.size();
+    return 2 * n;
+  });
+
+  r.name = "set_union";
+  measure(r, []{}, [&]{
+    array arr = base.set_union(other);
+    sink = arr.size();
+    return 2 * n;
+  });
+
+  r.name = "copy";
+  measure(r, []{}, [&]{
+    array arr(base);
+    sink = arr.size();
+    return n;
+  });
+
+  r.name = "assignment";
+  measure(r, [&]{ work.toEmpty(); work.push(extra[0]); }, [&]{
+    work = base;
+    return n;
+  });
+}
+
+/**
+ * @brief Benchmark delle operazioni su tutte le dimensioni da 1e2 a opts.maxSize,
+ * su input ordinati, invertiti, casuali e con molti duplicati, per int e keyValuePair.
+ *
+ */
+void benchSuite(){
+  const char *kinds[] = {"sorted", "reverse", "random", "duplicates"};
+  for(const char *kind : kinds){
+    for(long n = 100; n <= opts.maxSize; n *= 10){
+      benchOperations<int, int_crescent>("int", kind, n);
+      benchOperations<keyValuePair, kv_crescent>("keyValuePair", kind, n);
+    }
+  }
+}
+
+/**
+ * @brief Riproduce la push() originale: accoda l'elemento e riordina l'intero array
+ * con insertion sort. Usata come riferimento per il confronto.
+ *
+ * @param v array già ordinato
+ * @param element elemento da aggiungere
+ */
+void legacyPush(std::vector<int> &v, int element){
+  counting_crescent cmp;
+  v.push_back(element);
+  for(unsigned int i = 1; i < v.size(); ++i){
+    int aux = v[i];
+    int j = i - 1;
+    while(j >= 0 && cmp(aux, v[j])){
+      v[j + 1] = v[j];
+      --j;
+    }
+    v[j + 1] = aux;
+  }
+}
+
+/**
+ * @brief Confronta il numero di chiamate al funtore per n push() con la push originale
+ * e con quella basata su ricerca binaria.
+ *
+ */
+void benchPushComparisons(){
+  const char *kinds[] = {"sorted", "reverse", "random"};
+  for(long n = 100; n <= 10000 && n <= opts.maxSize; n *= 10){
+    for(const char *kind : kinds){
+      std::vector<int> input = makeInput<int>(n, kind);
+      result r = {"", "int", kind, n, 0, 0, 0};
+
+      r.name = "comparisons/push_legacy";
+      if(measure(r, []{ comparisons = 0; }, [&]{
+        std::vector<int> legacy;
+        for(int x : input){
+          legacyPush(legacy, x);
+        }
+        return n;
+      })){
+        results.back().comparisonsPerOp = static_cast<double>(comparisons) / n;
+      }
+
+      r.name = "comparisons/push";
+      if(measure(r, []{ comparisons = 0; }, [&]{
+        SortedArray<int, counting_crescent> arr;
+        for(int x : input){
+          arr.push(x);
+        }
+        return n;
+      })){
+        results.back().comparisonsPerOp = static_cast<double>(comparisons) / n;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Carico di lavoro di una singola richiesta: un SortedArray di breve durata
+ * riempito con push() e poi svuotato per metà con remove(), come nei test di main.cpp.
+ *
+ * @tparam A tipo dell'allocatore
+ * @param alloc allocatore del SortedArray
+ * @param input elementi da inserire
+ * @return int somma di controllo, per evitare che il lavoro venga eliminato dal compilatore
+ */
+template<typename A>
+int requestWorkload(const A &alloc, const std::vector<int> &input){
+  SortedArray<int, int_crescent, A> arr(alloc);
+  for(int x : input){
+    arr.push(x);
+  }
+  for(unsigned int i = 0; i < input.size(); i += 2){
+    arr.remove(input[i]);
+  }
+  return arr.size();
+}
+
+/**
+ * @brief Misura il tempo per richiesta di requestWorkload con un allocatore.
+ *
+ * @tparam A tipo dell'allocatore
+ * @tparam R funzione chiamata al termine di ogni richiesta (ad esempio il reset dell'arena)
+ * @param name nome dell'allocatore
+ * @param alloc allocatore
+ * @param input elementi di ogni richiesta
+ * @param reset funzione di fine richiesta
+ */
+template<typename A, typename R>
+void timeRequests(const char *name, const A &alloc, const std::vector<int> &input, R reset){
+  result r = {std::string("allocator/") + name, "int", "random", static_cast<long>(input.size()), 0, 0, -1};
+  measure(r, reset, [&]{
+    sink = requestWorkload(alloc, input);
+    return 1;
+  });
+}
+
+/**
+ * @brief Confronta l'allocatore di default con Arena, Pool e le risorse std::pmr
+ * su molte richieste brevi di push/remove.
+ *
+ */
+void benchAllocators(){
+  for(long n = 16; n <= 4096 && n <= opts.maxSize; n *= 4){
+    std::vector<int> input = makeInput<int>(n, "random");
+
+    timeRequests("std::allocator", std::allocator<int>(), input, []{});
+
+    Arena arena;
+    timeRequests("Arena", ArenaAllocator<int>(arena), input, [&arena]{ arena.reset(); });
+
+    Pool pool;
+    timeRequests("Pool", PoolAllocator<int>(pool), input, []{});
+
+    std::pmr::monotonic_buffer_resource monotonic;
+    timeRequests("pmr::monotonic", std::pmr::polymorphic_allocator<int>(&monotonic), input, [&monotonic]{ monotonic.release(); });
+
+    std::pmr::unsynchronized_pool_resource unsynchronized;
+    timeRequests("pmr::unsynchronized_pool", std::pmr::polymorphic_allocator<int>(&unsynchronized), input, []{});
+  }
+}
+
+/**
+ * @brief Record di 64 byte con chiave intera, usato per confrontare la ricerca per chiave
+ * in un array di record (array of structures) e in una SortedMap (structure of arrays).
+ *
+ */
+struct record {
+  int key;
+  char payload[60];
+};
+
+/**
+ * @brief Funtore trasparente crescente sulla chiave di record.
+ *
+ */
+struct record_crescent {
+  typedef void is_transparent;
+
+  bool operator()(const record &a, const record &b) const {
+    return a.key < b.key;
+  }
+
+  bool operator()(const record &a, int key) const {
+    return a.key < key;
+  }
+
+  bool operator()(int key, const record &b) const {
+    return key < b.key;
+  }
+};
+
+/**
+ * @brief Ricerca per chiave in SortedArray<record> e in SortedMap<int, payload>,
+ * con chiavi casuali presenti nell'array.
+ *
+ */
+void benchMapLookup(){
+  for(long n = 1000; n <= opts.maxSize; n *= 10){
+    std::vector<int> keys = makeInput<int>(n, "random");
+    std::vector<int> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<record> records(n);
+    SortedMap<int, record, int_crescent> map;
+    map.reserve(n);
+    for(long i = 0; i < n; ++i){
+      records[i].key = sorted[i];
+      map.try_emplace(sorted[i], records[i]);
+    }
+    SortedArray<record, record_crescent> arr(records.begin(), records.end());
+    long k = std::min(n, 100000L);
+    result r = {"", "record", "random", n, 0, 0, -1};
+
+    r.name = "map/array_of_structures_find";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(long i = 0; i < k; ++i){
+        found += arr.find(keys[i]) != arr.end();
+      }
+      sink = found;
+      return k;
+    });
+
+    r.name = "map/structure_of_arrays_find";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(long i = 0; i < k; ++i){
+        found += map.find(keys[i]) != map.end();
+      }
+      sink = found;
+      return k;
+    });
+  }
+}
+
+/**
+ * @brief Confronta la ricerca binaria di SortedArray::lower_bound con EytzingerIndex
+ * su dimensioni che raddoppiano da 256 elementi, per individuare la dimensione oltre la
+ * quale l'indice conviene. Viene misurata anche la costruzione dell'indice.
+ *
+ */
+void benchIndex(){
+  for(long n = 256; n <= opts.maxSize; n *= 2){
+    std::vector<int> input = makeInput<int>(n, "random");
+    std::vector<int> probes = makeInput<int>(100000, "random", 11);
+    SortedArray<int, int_crescent> arr(input.begin(), input.end());
+    EytzingerIndex<int, int_crescent> index(arr);
+    result r = {"", "int", "random", n, 0, 0, -1};
+
+    r.name = "index/binary_search_lower_bound";
+    measure(r, []{}, [&]{
+      long sum = 0;
+      for(int x : probes){
+        sum += arr.lower_bound(x) - arr.begin();
+      }
+      sink = sum;
+      return static_cast<long>(probes.size());
+    });
+
+    index.rebuild();
+    r.name = "index/eytzinger_lower_bound";
+    measure(r, []{}, [&]{
+      long sum = 0;
+      for(int x : probes){
+        sum += index.lower_bound(x) - arr.begin();
+      }
+      sink = sum;
+      return static_cast<long>(probes.size());
+    });
+
+    r.name = "index/eytzinger_build";
+    measure(r, []{}, [&]{
+      index.rebuild();
+      return n;
+    });
+  }
+}
+
+/**
+ * @brief Costruzione di un SortedArray di opts.maxSize int casuali con il costruttore
+ * sequenziale e con quello parallelo, con 1, 2, 4, ... thread fino al numero di core.
+ *
+ */
+void benchParallelBuild(){
+  long n = opts.maxSize;
+  std::vector<int> input = makeInput<int>(n, "random");
+  result r = {"parallel/sequential_build", "int", "random", n, 0, 0, -1};
+  measure(r, []{}, [&]{
+    SortedArray<int, int_crescent> arr(input.begin(), input.end());
+    sink = arr.size();
+    return n;
+  });
+
+  unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+  for(unsigned int threads = 1; ; threads = std::min(threads * 2, cores)){
+    ThreadPool pool(threads);
+    r.name = "parallel/build_" + std::to_string(threads) + "_threads";
+    measure(r, []{}, [&]{
+      SortedArray<int, int_crescent> arr(input.begin(), input.end(), pool);
+      sink = arr.size();
+      return n;
+    });
+    if(threads == cores){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Costo di una lettura di ConcurrentSortedArray (istantanea senza lock) rispetto
+ * ad encountered() su un SortedArray protetto da un mutex, con un solo thread.
+ *
+ */
+void benchConcurrentRead(){
+  long n = std::min(opts.maxSize, 1000000L);
+  std::vector<int> input = makeInput<int>(n, "random");
+  std::vector<int> probes = makeInput<int>(100000, "random", 13);
+  SortedArray<int, int_crescent> arr(input.begin(), input.end());
+  ConcurrentSortedArray<int, int_crescent> shared(arr);
+  std::mutex lock;
+  result r = {"concurrent/mutex_encountered", "int", "random", n, 0, 0, -1};
+
+  measure(r, []{}, [&]{
+    long found = 0;
+    for(int x : probes){
+      std::lock_guard<std::mutex> guard(lock);
+      found += arr.encountered(x);
+    }
+    sink = found;
+    return static_cast<long>(probes.size());
+  });
+
+  r.name = "concurrent/snapshot_encountered";
+  measure(r, []{}, [&]{
+    long found = 0;
+    for(int x : probes){
+      found += shared.encountered(x);
+    }
+    sink = found;
+    return static_cast<long>(probes.size());
+  });
+}
+
+/**
+ * @brief Inserimento di n int casuali in LogSortedArray, con e senza filtri di Bloom,
+ * rispetto a SortedArray::push(), e costo di encountered() sulle strutture risultanti.
+ *
+ */
+void benchLogStructured(){
+  for(long n = 10000; n <= std::min(opts.maxSize, 1000000L); n *= 10){
+    std::vector<int> input = makeInput<int>(n, "random");
+    std::vector<int> probes = makeInput<int>(100000, "random", 17);
+    result r = {"lsm/sorted_array_push", "int", "random", n, 0, 0, -1};
+    measure(r, []{}, [&]{
+      SortedArray<int, int_crescent> arr;
+      for(int x : input){
+        arr.push(x);
+      }
+      sink = arr.size();
+      return n;
+    });
+
+    LogSortedArray<int, int_crescent> plain;
+    r.name = "lsm/log_push";
+    measure(r, [&]{ plain.toEmpty(); }, [&]{
+      for(int x : input){
+        plain.push(x);
+      }
+      return n;
+    });
+
+    LogSortedArray<int, int_crescent, std::hash<int> > bloom;
+    r.name = "lsm/log_bloom_push";
+    measure(r, [&]{ bloom.toEmpty(); }, [&]{
+      for(int x : input){
+        bloom.push(x);
+      }
+      return n;
+    });
+
+    r.name = "lsm/log_encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += plain.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+
+    r.name = "lsm/log_bloom_encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += bloom.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+
+    plain.compact();
+    r.name = "lsm/compacted_encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += plain.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+  }
+}
+
+/**
+ * @brief Aggiornamenti casuali (push() seguito da remove() di un elemento casuale) su un array
+ * di n int, con memoria flat_storage e tiered_storage, e costo di encountered().
+ *
+ */
+template<typename Storage>
+void benchStorage(const char *name, long n){
+  std::vector<int> input = makeInput<int>(n, "random");
+  std::vector<int> updates = makeInput<int>(20000, "random", 23);
+  sorted_sequence<int, int_crescent, Storage> arr(input.begin(), input.end());
+  result r = {std::string("storage/") + name + "_update", "int", "random", n, 0, 0, -1};
+  measure(r, []{}, [&]{
+    for(int x : updates){
+      arr.push(x);
+      arr.remove(x);
+    }
+    sink = arr.size();
+    return static_cast<long>(updates.size());
+  });
+
+  r.name = std::string("storage/") + name + "_encountered";
+  measure(r, []{}, [&]{
+    long found = 0;
+    for(int x : updates){
+      found += arr.encountered(x);
+    }
+    sink = found;
+    return static_cast<long>(updates.size());
+  });
+}
+
+void benchTiered(){
+  for(long n = 10000; n <= std::min(opts.maxSize, 1000000L); n *= 10){
+    benchStorage<flat_storage>("flat", n);
+    benchStorage<tiered_storage>("tiered", n);
+  }
+}
+
+/**
+ * @brief Avvio di un array di n int casuali: ricostruzione con insert() (per push() vedi
+ * lsm/sorted_array_push) rispetto all'apertura con mmap di un file salvato, e costo di encountered() sulla mappatura.
+ *
+ */
+void benchMapped(){
+  const std::string path = "bench_mapped.bin";
+  for(long n = 10000; n <= std::min(opts.maxSize, 1000000L); n *= 10){
+    std::vector<int> input = makeInput<int>(n, "random");
+    std::vector<int> probes = makeInput<int>(100000, "random", 17);
+    SortedArray<int, int_crescent> built(input.begin(), input.end());
+    result r = {"mapped/rebuild_insert", "int", "random", n, 0, 0, -1};
+    measure(r, []{}, [&]{
+      SortedArray<int, int_crescent> arr(input.begin(), input.end());
+      sink = arr.size();
+      return 1L;
+    });
+
+    MappedSortedArray<int, int_crescent>::save(path, built);
+    r.name = "mapped/open";
+    measure(r, []{}, [&]{
+      MappedSortedArray<int, int_crescent> arr(path);
+      sink = arr.size();
+      return 1L;
+    });
+
+    MappedSortedArray<int, int_crescent> mapped(path);
+    r.name = "mapped/encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += mapped.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+  }
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Serializzazione in un buffer di n int casuali e caricamento con VERIFY_ORDER
+ * e TRUST_SORTED, per elemento.
+ *
+ */
+void benchSerialization(){
+  for(long n = 10000; n <= std::min(opts.maxSize, 1000000L); n *= 10){
+    std::vector<int> input = makeInput<int>(n, "random");
+    SortedArray<int, int_crescent> arr(input.begin(), input.end());
+    std::vector<char> buffer;
+    result r = {"serialization/serialize", "int", "random", n, 0, 0, -1};
+    measure(r, [&]{ buffer.clear(); }, [&]{
+      serialize(arr, buffer);
+      return n;
+    });
+
+    SortedArray<int, int_crescent> loaded;
+    r.name = "serialization/deserialize_verify";
+    measure(r, []{}, [&]{
+      deserialize(loaded, buffer, VERIFY_ORDER);
+      return n;
+    });
+
+    r.name = "serialization/deserialize_trusted";
+    measure(r, []{}, [&]{
+      deserialize(loaded, buffer, TRUST_SORTED);
+      return n;
+    });
+  }
+}
+
+/**
+ * @brief Insieme di n identificatori ordinati con distanza media 4, compresso con
+ * CompressedSortedIntArray: scansione completa e encountered() rispetto a SortedArray.
+ * Il numero di byte per elemento è riportato nel nome dei casi bytes_per_element.
+ *
+ */
+void benchCompressed(){
+  for(long n = 10000; n <= std::min(opts.maxSize, 1000000L); n *= 10){
+    std::vector<int> ids(n);
+    std::mt19937 gen(29);
+    int id = 0;
+    for(long i = 0; i < n; ++i){
+      id += 1 + gen() % 7;
+      ids[i] = id;
+    }
+    SortedArray<int, int_crescent> arr;
+    arr.append_sorted(ids.begin(), ids.end());
+    CompressedSortedIntArray<int_crescent> compressed(arr);
+    std::vector<int> probes(100000);
+    for(int &x : probes){
+      x = gen() % (id + 1);
+    }
+
+    result r = {"compressed/sorted_array_scan", "int", "ids", n, 0, 0, -1};
+    measure(r, []{}, [&]{
+      long sum = 0;
+      for(int x : arr){
+        sum += x;
+      }
+      sink = sum;
+      return n;
+    });
+
+    r.name = "compressed/scan";
+    measure(r, []{}, [&]{
+      long sum = 0;
+      compressed.for_each([&](int x){ sum += x; });
+      sink = sum;
+      return n;
+    });
+
+    r.name = "compressed/iterator_scan";
+    measure(r, []{}, [&]{
+      long sum = 0;
+      CompressedSortedIntArray<int_crescent>::scan_range values = compressed.scan();
+      for(CompressedSortedIntArray<int_crescent>::const_iterator it = values.begin(); it != values.end(); ++it){
+        sum += *it;
+      }
+      sink = sum;
+      return n;
+    });
+
+    r.name = "compressed/sorted_array_encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += arr.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+
+    r.name = "compressed/encountered";
+    measure(r, []{}, [&]{
+      long found = 0;
+      for(int x : probes){
+        found += compressed.encountered(x);
+      }
+      sink = found;
+      return static_cast<long>(probes.size());
+    });
+
+    r.name = "compressed/bytes_per_element";
+    if(opts.filter.empty() || r.name.find(opts.filter) != std::string::npos){
+      r.iterations = 1;
+      r.nsPerOp = static_cast<double>(compressed.bytes()) / n;
+      results.push_back(r);
+    }
+  }
+}
+
+/**
+ * @brief Stampa i risultati in formato CSV o JSON.
+ *
+ */
+void report(){
+  if(opts.format == "json"){
+    std::cout << "{\"benchmarks\": [" << std::endl;
+    for(unsigned int i = 0; i < results.size(); ++i){
+      const result &r = results[i];
+      std::cout << "  {\"name\": \"" << r.name << "\", \"payload\": \"" << r.payload
+                << "\", \"input\": \"" << r.input << "\", \"n\": " << r.n
+                << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp;
+      if(r.comparisonsPerOp >= 0){
+        std::cout << ", \"comparisons_per_op\": " << r.comparisonsPerOp;
+      }
+      std::cout << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    std::cout << "]}" << std::endl;
+    return;
+  }
+
+  std::cout << "name,payload,input,n,iterations,ns_per_op,comparisons_per_op" << std::endl;
+  for(const result &r : results){
+    std::cout << r.name << "," << r.payload << "," << r.input << "," << r.n << ","
+              << r.iterations << "," << r.nsPerOp << ",";
+    if(r.comparisonsPerOp >= 0){
+      std::cout << r.comparisonsPerOp;
+    }
+    std::cout << std::endl;
+  }
+}
+
+/**
+ * @brief Suite di benchmark di SortedArray.
+ *
+ * Opzioni:
+ *   --format=csv|json   formato dell'output (default csv)
+ *   --filter=testo      esegue solo i benchmark il cui nome contiene testo
+ *   --max-size=n        dimensione massima degli array (default 10000000)
+ *   --min-time=s        tempo minimo misurato per ogni caso, in secondi (default 0.05)
+ */
+int main(int argc, char* argv[]){
+
+    for(int i = 1; i < argc; ++i){
+      std::string arg(argv[i]);
+      if(arg.compare(0, 9, "--format=") == 0) opts.format = arg.substr(9);
+      else if(arg.compare(0, 9, "--filter=") == 0) opts.filter = arg.substr(9);
+      else if(arg.compare(0, 11, "--max-size=") == 0) opts.maxSize = std::atol(arg.c_str() + 11);
+      else if(arg.compare(0, 11, "--min-time=") == 0) opts.minTimeNs = std::atof(arg.c_str() + 11) * 1e9;
+      else {
+        std::cerr << "opzione sconosciuta: " << arg << std::endl;
+        return 1;
+      }
+    }
+
+    benchSuite();
+    benchPushComparisons();
+    benchAllocators();
+    benchMapLookup();
+    benchIndex();
+    benchParallelBuild();
+    benchConcurrentRead();
+    benchLogStructured();
+    benchTiered();
+    benchMapped();
+    benchSerialization();
+    benchCompressed();
+    report();
+}
@@ -1,119 +1,55 @@
 #include "SortedArray.h"
+#include "SortedSet.h"
+#include "SortedMap.h"
+#include "EytzingerIndex.h"
+#include "ParallelBuild.h"
+#include "ConcurrentSortedArray.h"
+#include "LogSortedArray.h"
+#include "TieredSortedArray.h"
+#include "MappedSortedArray.h"
+#include "SortedArraySerialization.h"
+#include "CompressedSortedIntArray.h"
+#include "Allocators.h"
+#include "TestTypes.h"
 #include <cassert>
 #include <vector>
 #include <iterator>
+#include <string>
+#include <functional>
+#include <climits>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <sstream>
 /**
- * @brief Funtore di confronto tra interi: utilizzato per stabilire un ordine crescente
- * all'interno di un SortedArray.
+ * @brief Tipo senza costruttore di default che conta le istanze vive.
+ * Utilizzato per verificare che il SortedArray costruisca e distrugga solo gli elementi presenti.
  * 
  */
-struct int_crescent {
-  bool operator()(int a, int b) const {
-    return a<b;
-  }
-};
-
-/**
- * @brief Funtore di confronto tra interi: utilizzato per stabilire un ordine decrescente
- * all'interno di un SortedArray.
- * 
- */
-struct int_decrescent {
-  bool operator()(int a, int b) const {
-    return a>b;
-  }
-};
-
-/**
-  @brief Funtore predicato 
-
-  Ritorna true se il valore intero passato è pari 
-*/
-struct is_even {
-  bool operator()(int a) const {
-    return (a % 2 ==0);
-  }
-};
-
-
-/**
- * @brief Tipo Custom contenente una coppia chiave-valore.
- * Utilizzata per il test su tipi custom.
- * 
- */
-struct keyValuePair{
+struct tracked{
 
-  keyValuePair(int k, char v): key(k), value(v) {};
-  keyValuePair(): key(0), value('0'){};
+  explicit tracked(int v): value(v) { ++alive; }
+  tracked(const tracked &other) noexcept: value(other.value) { ++alive; }
+  ~tracked() { --alive; }
+  tracked& operator=(const tracked &other) { value = other.value; return *this; }
 
-/**
- * @brief Operatore maggiore.
- * Confronta la chiave di due keyValuePair e ritorna true se la chiave di *this è maggiore.
- * 
- * @param other 
- * @return true 
- * @return false 
- */
-  bool operator>(keyValuePair &other){
-    return key > other.key;
+  bool operator==(const tracked &other) const {
+    return value == other.value;
   }
 
-/**
- * @brief Operatore minore.
- * Confronta la chiave di due keyValuePair e ritorna true se la chiave di *this è minore.
- * 
- * @param other 
- * @return true 
- * @return false 
- */
-  bool operator<(keyValuePair &other){
-    return key < other.key;
-  }
-
-/**
- * @brief Operatore uguale.
- * Confronta le variabili key e value di due keyValuePair, e ritorna true
- * se combaciano.
- * 
- * @param other 
- * @return true 
- * @return false 
- */
-  bool operator==(keyValuePair other){
-    if(key == other.key && value == other.value){
-      return true;
-    }
-    return false;
-  }
-
-  public:
-    int key;
-    char value;
-    
-
+  int value;
+  static int alive;
 };
 
-/**
- * @brief Operatore di stream per keyValuePair.
- * Stampa a video i valori di key e value.
- * 
- * @param os 
- * @param kvp 
- * @return std::ostream& 
- */
-std::ostream& operator<<(std::ostream& os, const keyValuePair& kvp) {
-    os << "Key: " << kvp.key << ", Value: " << kvp.value;
-    return os;
-}
+int tracked::alive = 0;
 
 /**
- * @brief Funtore di confronto tra oggetti di tipo keyValuePair.
- * Effettua il confronto utilizzando l'operatore > della struct.
+ * @brief Funtore di confronto crescente tra oggetti di tipo tracked.
  * 
  */
-struct kv_crescent{
-  bool operator()(keyValuePair a, keyValuePair b) const {
-    return a > b;
+struct tracked_crescent{
+  bool operator()(const tracked &a, const tracked &b) const {
+    return a.value < b.value;
   }
 };
 
@@ -144,10 +80,10 @@ void testRemove(){
 
   std::cout << "Stato array prima delle remove degli elementi: " << std::endl;
 
-  arr.remove(4);
-  arr.remove(1);
-  arr.remove(3);
-  arr.remove(9);
+  assert(arr.remove(4));
+  assert(arr.remove(1));
+  assert(arr.remove(3));
+  assert(!arr.remove(9));
 
   std::cout << "Risultato testRemove: " << std::endl << arr <<std::endl;   
   std::cout << std::endl;
@@ -306,7 +242,8 @@ void testFilter(){
 
   is_even ie;
 
-  arr.filter(ie);  
+  SortedArray<int, int_decrescent>::size_type removed = arr.filter(ie);
+  assert(removed == 8);
 
   std::cout << "testFilter: stato array dopo la funzione (rimozione interi pari): " << std::endl << arr;    
 
@@ -391,7 +328,1782 @@ void testCustom(){
 
 }
 
+/**
+ * @brief Test della gestione della capacità: crescita geometrica, reserve(), shrink_to_fit()
+ * e politica MINIMAL.
+ * 
+ */
+void testCapacita(){
+
+  std::cout << "testCapacita" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  assert(arr.capacity() == 0);
+  for(int i = 0; i < 5; ++i){
+    arr.push(i);
+  }
+  assert(arr.size() == 5);
+  assert(arr.capacity() == 8);
+
+  arr.reserve(20);
+  assert(arr.capacity() == 20);
+  assert(arr.size() == 5);
+
+  arr.shrink_to_fit();
+  assert(arr.capacity() == 5);
+
+  SortedArray<int, int_crescent> arr2(SortedArray<int, int_crescent>::MINIMAL);
+  for(int i = 0; i < 5; ++i){
+    arr2.push(i);
+    assert(arr2.capacity() == arr2.size());
+  }
+  arr2.remove(3);
+  assert(arr2.capacity() == 4);
+
+  arr.setPolicy(SortedArray<int, int_crescent>::MINIMAL);
+  arr.push(7);
+  assert(arr.capacity() == 6);
+
+  std::cout << arr << std::endl;
+
+}
+
+/**
+ * @brief Test della stabilità di push(): gli elementi equivalenti mantengono l'ordine di inserimento.
+ * 
+ */
+void testPushStabile(){
+
+  std::cout << "testPushStabile" << std::endl << std::endl;
+
+  SortedArray<keyValuePair, kv_crescent> arr;
+  arr.push(keyValuePair(1, 'a'));
+  arr.push(keyValuePair(5, 'x'));
+  arr.push(keyValuePair(1, 'b'));
+  arr.push(keyValuePair(0, 'y'));
+  arr.push(keyValuePair(1, 'c'));
+
+  SortedArray<keyValuePair, kv_crescent>::iterator it = arr.begin();
+  assert(it[0] == keyValuePair(5, 'x'));
+  assert(it[1] == keyValuePair(1, 'a'));
+  assert(it[2] == keyValuePair(1, 'b'));
+  assert(it[3] == keyValuePair(1, 'c'));
+  assert(it[4] == keyValuePair(0, 'y'));
+
+  std::cout << arr << std::endl;
+
+}
+
+/**
+ * @brief Test delle ricerche binarie find, lower_bound, upper_bound, equal_range e count.
+ * 
+ */
+void testRicerca(){
+
+  std::cout << "testRicerca" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  arr.push(5);
+  arr.push(1);
+  arr.push(3);
+  arr.push(3);
+  arr.push(9);
+  arr.push(3);
+
+  assert(arr.lower_bound(3) - arr.begin() == 1);
+  assert(arr.upper_bound(3) - arr.begin() == 4);
+  assert(arr.lower_bound(4) == arr.upper_bound(4));
+  assert(arr.lower_bound(10) == arr.end());
+  assert(arr.count(3) == 3);
+  assert(arr.count(4) == 0);
+  assert(*arr.find(9) == 9);
+  assert(arr.find(7) == arr.end());
+
+  std::pair<SortedArray<int, int_crescent>::iterator, SortedArray<int, int_crescent>::iterator> range = arr.equal_range(3);
+  assert(range.second - range.first == 3);
+  for(; range.first != range.second; ++range.first){
+    assert(*range.first == 3);
+  }
+
+  SortedArray<keyValuePair, kv_crescent> kv;
+  kv.push(keyValuePair(2, 'a'));
+  kv.push(keyValuePair(2, 'b'));
+  kv.push(keyValuePair(4, 'c'));
+  assert(kv.count(keyValuePair(2, 'z')) == 2);
+  assert(kv.encountered(keyValuePair(2, 'b')));
+  assert(!kv.encountered(keyValuePair(2, 'z')));
+  kv.remove(keyValuePair(2, 'b'));
+  assert(kv.size() == 2);
+  assert(kv.encountered(keyValuePair(2, 'a')));
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Test della rimozione in place con erase(iterator) ed erase(first, last).
+ * 
+ */
+void testErase(){
+
+  std::cout << "testErase" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  for(int i = 0; i < 10; ++i){
+    arr.push(i);
+  }
+  SortedArray<int, int_crescent>::size_type cap = arr.capacity();
+
+  SortedArray<int, int_crescent>::iterator it = arr.erase(arr.find(4));
+  assert(*it == 5);
+  assert(arr.size() == 9);
+  assert(!arr.encountered(4));
+
+  it = arr.erase(arr.lower_bound(2), arr.upper_bound(7));
+  assert(*it == 8);
+  assert(arr.size() == 4);
+  assert(arr.capacity() == cap);
+
+  it = arr.begin();
+  assert(it[0] == 0 && it[1] == 1 && it[2] == 8 && it[3] == 9);
+
+  arr.remove(9);
+  it = arr.erase(arr.begin(), arr.end());
+  assert(it == arr.end());
+  assert(arr.size() == 0);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Test della funzione partition_out(F parameter), che sposta gli elementi che soddisfano
+ * parameter in un nuovo SortedArray già ordinato.
+ * 
+ */
+void testPartitionOut(){
+
+  std::cout << "testPartitionOut" << std::endl << std::endl;
+
+  SortedArray<int, int_decrescent> arr;
+  for(int i = 1; i <= 9; ++i){
+    arr.push(i);
+  }
+
+  is_even ie;
+  SortedArray<int, int_decrescent> even = arr.partition_out(ie);
+
+  assert(arr.size() == 5);
+  assert(even.size() == 4);
+  SortedArray<int, int_decrescent>::iterator it = even.begin();
+  assert(it[0] == 8 && it[1] == 6 && it[2] == 4 && it[3] == 2);
+  it = arr.begin();
+  assert(it[0] == 9 && it[1] == 7 && it[2] == 5 && it[3] == 3 && it[4] == 1);
+
+  std::cout << "Elementi rimasti: " << std::endl << arr;
+  std::cout << "Elementi rimossi: " << std::endl << even;
 
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Test dell'inserimento a blocchi con insert(first, last) e push_many().
+ * 
+ */
+void testInsert(){
+
+  std::cout << "testInsert" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  arr.push_many({7, 3, 9, 1});
+
+  std::vector<int> v {8, 2, 10, 3};
+  arr.insert(v.begin(), v.end());
+  arr.push_many({11, 12});
+  assert(arr.size() == 10);
+
+  int expected[] = {1, 2, 3, 3, 7, 8, 9, 10, 11, 12};
+  SortedArray<int, int_crescent>::iterator it = arr.begin();
+  for(int i = 0; i < 10; ++i){
+    assert(it[i] == expected[i]);
+  }
+
+  SortedArray<int, int_crescent> big;
+  std::vector<int> values;
+  for(int i = 0; i < 100; ++i){
+    values.push_back((i * 37) % 100);
+  }
+  big.insert(values.begin(), values.end());
+  big.push_many({50, 0, 99});
+  it = big.begin();
+  for(int i = 1; i < big.size(); ++i){
+    assert(it[i - 1] <= it[i]);
+  }
+  assert(big.count(50) == 2);
+
+  SortedArray<keyValuePair, kv_crescent> kv;
+  kv.push(keyValuePair(2, 'a'));
+  kv.push_many({keyValuePair(2, 'b'), keyValuePair(3, 'c'), keyValuePair(2, 'd')});
+  SortedArray<keyValuePair, kv_crescent>::iterator kit = kv.begin();
+  assert(kit[0] == keyValuePair(3, 'c'));
+  assert(kit[1] == keyValuePair(2, 'a'));
+  assert(kit[2] == keyValuePair(2, 'b'));
+  assert(kit[3] == keyValuePair(2, 'd'));
+
+  std::cout << arr << std::endl;
+
+}
+
+/**
+ * @brief Test di sort() su sequenze casuali, ordinate, invertite e con molti duplicati:
+ * il risultato deve coincidere con quello di std::stable_sort.
+ * 
+ */
+void testSort(){
+
+  std::cout << "testSort" << std::endl << std::endl;
+
+  std::vector<keyValuePair> input;
+  for(int i = 0; i < 5000; ++i){
+    input.push_back(keyValuePair((i * 7919) % 101, static_cast<char>('a' + i % 26)));
+  }
+  for(int i = 0; i < 300; ++i){
+    input.push_back(keyValuePair(200 + i, 'z'));
+  }
+  for(int i = 0; i < 300; ++i){
+    input.push_back(keyValuePair(-i, 'y'));
+  }
+
+  SortedArray<keyValuePair, kv_crescent> arr(input.begin(), input.end());
+  std::stable_sort(input.begin(), input.end(), kv_crescent());
+
+  SortedArray<keyValuePair, kv_crescent>::iterator it = arr.begin();
+  assert(arr.size() == static_cast<int>(input.size()));
+  for(unsigned int i = 0; i < input.size(); ++i){
+    assert(it[i] == input[i]);
+  }
+
+  std::vector<int> sorted;
+  for(int i = 0; i < 1000; ++i){
+    sorted.push_back(i / 3);
+  }
+  SortedArray<int, int_crescent> up(sorted.begin(), sorted.end());
+  SortedArray<int, int_decrescent> down(sorted.begin(), sorted.end());
+  SortedArray<int, int_crescent>::iterator uit = up.begin();
+  SortedArray<int, int_decrescent>::iterator dit = down.begin();
+  for(int i = 1; i < 1000; ++i){
+    assert(uit[i - 1] <= uit[i]);
+    assert(dit[i - 1] >= dit[i]);
+  }
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Test della semantica di spostamento: move constructor, assegnamento per spostamento,
+ * push di rvalue, emplace() e SortedArray all'interno di std::vector.
+ * 
+ */
+void testMove(){
+
+  std::cout << "testMove" << std::endl << std::endl;
+
+  SortedArray<std::string, std::less<std::string> > arr;
+  std::string s("banana");
+  arr.push(std::move(s));
+  assert(s.empty());
+  arr.push(std::string("ciliegia"));
+  SortedArray<std::string, std::less<std::string> >::iterator it = arr.emplace(3, 'a');
+  assert(*it == "aaa");
+  assert(*arr.begin() == "aaa");
+
+  SortedArray<std::string, std::less<std::string> > moved(std::move(arr));
+  assert(moved.size() == 3);
+  assert(arr.size() == 0);
+  arr.push("dattero");
+  assert(arr.size() == 1);
+
+  arr = std::move(moved);
+  assert(arr.size() == 3);
+  assert(moved.size() == 0);
+  assert(arr.encountered("ciliegia"));
+
+  std::vector<SortedArray<int, int_crescent> > v;
+  for(int i = 0; i < 10; ++i){
+    SortedArray<int, int_crescent> tmp;
+    tmp.push(i);
+    tmp.push(-i);
+    v.push_back(std::move(tmp));
+  }
+  assert(v[9].size() == 2);
+  assert(*v[9].begin() == -9);
+
+  std::cout << arr << std::endl;
+
+}
+
+/**
+ * @brief Test della gestione della memoria non inizializzata: il tipo tracked non ha
+ * costruttore di default, e il numero di istanze vive deve coincidere con size().
+ * 
+ */
+void testMemoria(){
+
+  std::cout << "testMemoria" << std::endl << std::endl;
+
+  {
+    SortedArray<tracked, tracked_crescent> arr;
+    for(int i = 0; i < 20; ++i){
+      arr.push(tracked((i * 7) % 20));
+    }
+    assert(tracked::alive == 20);
+    arr.reserve(100);
+    assert(tracked::alive == 20);
+
+    arr.remove(tracked(3));
+    arr.erase(arr.begin(), arr.begin() + 5);
+    assert(tracked::alive == 14);
+
+    std::vector<tracked> batch;
+    for(int i = 0; i < 10; ++i){
+      batch.push_back(tracked(i * 3));
+    }
+    arr.insert(batch.begin(), batch.end());
+    assert(tracked::alive == 34);
+    batch.clear();
+    assert(tracked::alive == arr.size());
+
+    arr.filter([](const tracked &t){ return t.value % 2 == 0; });
+    assert(tracked::alive == arr.size());
+
+    // un predicato che lancia un'eccezione lascia l'array valido, senza elementi distrutti due volte
+    int before = arr.size();
+    int calls = 0;
+    bool thrown = false;
+    try{
+      arr.filter([&calls](const tracked &t){
+        if(++calls == 6){
+          throw std::runtime_error("filter");
+        }
+        return t.value % 3 == 0;
+      });
+    } catch(const std::runtime_error &){
+      thrown = true;
+    }
+    assert(thrown && tracked::alive == arr.size() && arr.size() <= before);
+    for(int i = 1; i < arr.size(); ++i){
+      assert(arr.begin()[i - 1].value <= arr.begin()[i].value);
+    }
+    calls = 0;
+    thrown = false;
+    try{
+      SortedArray<tracked, tracked_crescent> odd = arr.partition_out([&calls](const tracked &t){
+        if(++calls == 4){
+          throw std::runtime_error("partition_out");
+        }
+        return t.value % 2 == 1;
+      });
+    } catch(const std::runtime_error &){
+      thrown = true;
+    }
+    assert(thrown && tracked::alive == arr.size());
+
+    SortedArray<tracked, tracked_crescent> copy(arr);
+    copy.shrink_to_fit();
+    assert(tracked::alive == 2 * arr.size());
+
+    std::vector<tracked> unsorted;
+    for(int i = 0; i < 200; ++i){
+      unsorted.push_back(tracked((i * 31) % 97));
+    }
+    SortedArray<tracked, tracked_crescent> built(unsorted.begin(), unsorted.end());
+    SortedArray<tracked, tracked_crescent>::iterator it = built.begin();
+    for(int i = 1; i < built.size(); ++i){
+      assert(it[i - 1].value <= it[i].value);
+    }
+  }
+  assert(tracked::alive == 0);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Test dei SortedArray con allocatore personalizzato: Arena, Pool e std::pmr.
+ * 
+ */
+void testAllocatori(){
+
+  std::cout << "testAllocatori" << std::endl << std::endl;
+
+  Arena arena(1024);
+  {
+    SortedArray<int, int_crescent, ArenaAllocator<int> > arr((ArenaAllocator<int>(arena)));
+    for(int i = 0; i < 1000; ++i){
+      arr.push((i * 13) % 1000);
+    }
+    arr.remove(500);
+    assert(arr.size() == 999);
+    assert(!arr.encountered(500));
+    assert(arr.get_allocator().resource() == &arena);
+
+    SortedArray<int, int_crescent, ArenaAllocator<int> > copy(arr);
+    assert(copy.get_allocator() == arr.get_allocator());
+  }
+  arena.reset();
+
+  Pool pool;
+  {
+    SortedArray<tracked, tracked_crescent, PoolAllocator<tracked> > arr((PoolAllocator<tracked>(pool)));
+    SortedArray<tracked, tracked_crescent, PoolAllocator<tracked> > arr2((PoolAllocator<tracked>(pool)));
+    for(int i = 0; i < 100; ++i){
+      arr.push(tracked(100 - i));
+      arr2.emplace(i);
+    }
+    arr2 = arr;
+    arr.filter([](const tracked &t){ return t.value > 50; });
+    assert(arr.size() == 50);
+    assert(arr2.size() == 100);
+    arr = std::move(arr2);
+    assert(arr.size() == 100);
+    assert(tracked::alive == 100);
+  }
+  assert(tracked::alive == 0);
+
+  Pool tiny(1, 0);
+  {
+    SortedArray<int, int_crescent, PoolAllocator<int> > arr((PoolAllocator<int>(tiny)));
+    for(int i = 0; i < 100; ++i){
+      arr.push(i);
+    }
+    assert(arr.size() == 100);
+  }
+
+  std::pmr::monotonic_buffer_resource resource;
+  std::pmr::unsynchronized_pool_resource other;
+  {
+    typedef SortedArray<int, int_decrescent, std::pmr::polymorphic_allocator<int> > pmr_array;
+    pmr_array arr(&resource);
+    arr.push_many({3, 1, 2});
+    pmr_array arr2(&other);
+    arr2.push(7);
+
+    arr2 = arr;
+    assert(arr2.get_allocator().resource() == &other);
+    arr2 = std::move(arr);
+    assert(arr2.get_allocator().resource() == &other);
+    assert(arr2.size() == 3);
+    assert(*arr2.begin() == 3);
+  }
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Funtore crescente che conta le proprie chiamate.
+ * 
+ */
+struct counting_crescent{
+  static unsigned long long calls;
+
+  bool operator()(int a, int b) const{
+    ++calls;
+    return a < b;
+  }
+};
+
+unsigned long long counting_crescent::calls = 0;
+
+void testStatistiche(){
+
+  std::cout << "testStatistiche" << std::endl << std::endl;
+
+  SortedArray<int, counting_crescent> arr;
+  counting_crescent::calls = 0;
+  for(int i = 0; i < 100; ++i){
+    arr.push((i * 37) % 100);
+  }
+  arr.insert(arr.begin(), arr.begin() + 10);
+  arr.remove(42);
+  assert(arr.encountered(7));
+  arr.filter(is_even());
+  arr.sort();
+
+  const sorted_array_stats &stats = arr.stats();
+
+#ifdef SORTEDARRAY_STATS
+  assert(stats.comparisons == counting_crescent::calls);
+  assert(stats.allocations > 0);
+  assert(stats.reallocations > 0);
+  assert(stats.bytes_allocated >= 100 * sizeof(int));
+  assert(stats.copies >= 10);
+  assert(stats.moves > 0);
+  assert(stats.calls[sorted_array_stats::PUSH] == 100);
+  assert(stats.calls[sorted_array_stats::INSERT] == 1);
+  assert(stats.calls[sorted_array_stats::ERASE] == 1);
+  assert(stats.calls[sorted_array_stats::LOOKUP] == 2);
+  assert(stats.calls[sorted_array_stats::FILTER] == 1);
+  assert(stats.calls[sorted_array_stats::SORT] == 1);
+
+  SortedArray<int, counting_crescent> copy(arr);
+  assert(copy.stats().copies == (unsigned long long)arr.size());
+  assert(copy.stats().comparisons == 0);
+
+  sorted_array_stats saved = stats;
+  arr.resetStats();
+  assert(stats.comparisons == 0);
+  assert(stats.calls[sorted_array_stats::PUSH] == 0);
+  assert(saved.calls[sorted_array_stats::PUSH] == 100);
+  arr.push(1);
+  assert(stats.calls[sorted_array_stats::PUSH] == 1);
+#else
+  assert(counting_crescent::calls > 0);
+  assert(stats.comparisons == 0);
+  assert(stats.calls[sorted_array_stats::PUSH] == 0);
+  arr.resetStats();
+#endif
+
+  std::cout << std::endl;
+
+}
+
+void testInsiemi(){
+
+  std::cout << "testInsiemi" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> a;
+  a.push_many({1, 2, 2, 2, 4, 6, 8});
+  SortedArray<int, int_crescent> b;
+  b.push_many({2, 2, 3, 6, 9});
+
+  SortedArray<int, int_crescent> m = a.merge(b);
+  std::vector<int> expected = {1, 2, 2, 2, 2, 2, 3, 4, 6, 6, 8, 9};
+  assert(std::vector<int>(m.begin(), m.end()) == expected);
+
+  SortedArray<int, int_crescent> u = a.set_union(b);
+  expected = {1, 2, 2, 2, 3, 4, 6, 8, 9};
+  assert(std::vector<int>(u.begin(), u.end()) == expected);
+
+  SortedArray<int, int_crescent> in = a.set_intersection(b);
+  expected = {2, 2, 6};
+  assert(std::vector<int>(in.begin(), in.end()) == expected);
+
+  SortedArray<int, int_crescent> d = a.set_difference(b);
+  expected = {1, 2, 4, 8};
+  assert(std::vector<int>(d.begin(), d.end()) == expected);
+
+  assert(a.includes(in));
+  assert(a.includes(d));
+  assert(!a.includes(b));
+  SortedArray<int, int_crescent> empty;
+  assert(a.includes(empty));
+  assert(empty.merge(a).size() == a.size());
+  assert(a.set_difference(empty).size() == a.size());
+
+  // a parità di chiave gli elementi di this precedono quelli di other
+  SortedArray<keyValuePair, kv_crescent> kv1;
+  kv1.push(keyValuePair(1, 'a'));
+  SortedArray<keyValuePair, kv_crescent> kv2;
+  kv2.push(keyValuePair(1, 'b'));
+  kv2.push(keyValuePair(2, 'c'));
+  SortedArray<keyValuePair, kv_crescent> kvm = kv1.merge(kv2);
+  assert(kvm.size() == 3);
+  assert((kvm.begin() + 1)->value == 'a');
+  assert((kvm.begin() + 2)->value == 'b');
+  assert(kv1.set_union(kv2).size() == 2);
+
+  // merge per spostamento: stesso risultato, senza copie, e gli array di origine rimangono vuoti
+  SortedArray<int, int_crescent> a2(a);
+  SortedArray<int, int_crescent> b2(b);
+  SortedArray<int, int_crescent> moved = a2.merge(std::move(b2));
+  assert(std::equal(moved.begin(), moved.end(), m.begin(), m.end()));
+  assert(a2.size() == 0 && b2.size() == 0);
+#ifdef SORTEDARRAY_STATS
+  assert(moved.stats().copies == 0);
+#endif
+  SortedArray<keyValuePair, kv_crescent> kvMoved = kv1.merge(std::move(kv2));
+  assert(kvMoved.size() == 3 && (kvMoved.begin() + 1)->value == 'a' && (kvMoved.begin() + 2)->value == 'b');
+  assert(tracked::alive == 0);
+  {
+    SortedArray<tracked, tracked_crescent> t1;
+    SortedArray<tracked, tracked_crescent> t2;
+    for(int i = 0; i < 10; ++i){
+      t1.push(tracked(2 * i));
+      t2.push(tracked(3 * i));
+    }
+    SortedArray<tracked, tracked_crescent> tm = t1.merge(std::move(t2));
+    assert(tracked::alive == 20 && tm.size() == 20);
+    assert(std::is_sorted(tm.begin(), tm.end(), tracked_crescent()));
+  }
+  assert(tracked::alive == 0);
+
+  // stesso funtore: il costruttore secondario non riordina
+  SortedArray<short, counting_crescent> shorts;
+  for(short i = 0; i < 50; ++i){
+    shorts.push(i);
+  }
+  counting_crescent::calls = 0;
+  SortedArray<int, counting_crescent> ints(shorts);
+  assert(counting_crescent::calls == 0);
+  assert(ints.size() == 50);
+  assert(*ints.begin() == 0);
+  assert(*(ints.end() - 1) == 49);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Funtore crescente su tracked che lancia un'eccezione alla chiamata numero limit.
+ * 
+ */
+struct throwing_crescent{
+  bool operator()(const tracked &a, const tracked &b) const {
+    if(++calls == limit){
+      throw std::runtime_error("confronto");
+    }
+    return a.value < b.value;
+  }
+
+  static int calls;
+  static int limit;
+};
+
+int throwing_crescent::calls = 0;
+int throwing_crescent::limit = -1;
+
+void testUnique(){
+
+  std::cout << "testUnique" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  arr.push_many({5, 1, 3, 3, 1, 5, 5, 2, 3});
+  assert(arr.unique() == 5);
+  std::vector<int> expected = {1, 2, 3, 5};
+  assert(std::vector<int>(arr.begin(), arr.end()) == expected);
+  assert(arr.unique() == 0);
+
+  // viene mantenuto il primo elemento di ogni gruppo di equivalenti
+  SortedArray<keyValuePair, kv_crescent> kv;
+  kv.push(keyValuePair(1, 'a'));
+  kv.push(keyValuePair(2, 'b'));
+  kv.push(keyValuePair(1, 'c'));
+  assert(kv.unique() == 1);
+  assert(kv.size() == 2);
+  assert((kv.begin() + 1)->value == 'a');
+
+  assert(tracked::alive == 0);
+  {
+    SortedArray<tracked, tracked_crescent> tr;
+    for(int i = 0; i < 20; ++i){
+      tr.push(tracked(i % 4));
+    }
+    assert(tr.unique() == 16);
+    assert(tracked::alive == 4);
+  }
+  assert(tracked::alive == 0);
+  {
+    // un confronto che lancia un'eccezione lascia l'array valido
+    SortedArray<tracked, throwing_crescent> tr;
+    for(int i = 0; i < 20; ++i){
+      tr.push(tracked(i % 4));
+    }
+    throwing_crescent::calls = 0;
+    throwing_crescent::limit = 10;
+    bool thrown = false;
+    try{
+      tr.unique();
+    } catch(const std::runtime_error &){
+      thrown = true;
+    }
+    throwing_crescent::limit = -1;
+    assert(thrown && tracked::alive == tr.size() && tr.size() < 20);
+  }
+  assert(tracked::alive == 0);
+
+  std::pair<SortedArray<int, int_crescent>::iterator, bool> r = arr.insert_unique(4);
+  assert(r.second && *r.first == 4);
+  r = arr.insert_unique(3);
+  assert(!r.second && *r.first == 3);
+  assert(arr.size() == 5);
+
+  std::cout << std::endl;
+
+}
+
+void testSortedSet(){
+
+  std::cout << "testSortedSet" << std::endl << std::endl;
+
+  SortedSet<int, int_crescent> set = {4, 1, 4, 2, 1};
+  assert(set.size() == 3);
+
+  std::pair<SortedSet<int, int_crescent>::iterator, bool> r = set.insert(3);
+  assert(r.second);
+  assert(*r.first == 3);
+  r = set.insert(3);
+  assert(!r.second);
+  assert(*r.first == 3);
+  assert(set.emplace(0).second);
+  assert(set.size() == 5);
+
+  assert(set.insert({2, 9, 9, 7}) == 2);
+  std::vector<int> expected = {0, 1, 2, 3, 4, 7, 9};
+  assert(std::vector<int>(set.begin(), set.end()) == expected);
+
+  assert(set.contains(7));
+  assert(set.count(7) == 1);
+  assert(set.erase(7) == 1);
+  assert(set.erase(7) == 0);
+  assert(!set.contains(7));
+  assert(set.find(8) == set.end());
+
+  SortedSet<int, int_crescent> other = {3, 4, 5};
+  SortedSet<int, int_crescent> u = set.set_union(other);
+  expected = {0, 1, 2, 3, 4, 5, 9};
+  assert(std::vector<int>(u.begin(), u.end()) == expected);
+  assert(set.set_intersection(other).size() == 2);
+  assert(set.set_difference(other).size() == 4);
+  assert(u.includes(set));
+  assert(!set.includes(other));
+
+  std::vector<int> values = {3, 3, 3, 1};
+  SortedSet<int, int_crescent> fromRange(values.begin(), values.end());
+  assert(fromRange.size() == 2);
+
+  // a parità di chiave viene mantenuto l'elemento già presente
+  SortedSet<keyValuePair, kv_crescent> kv;
+  assert(kv.insert(keyValuePair(1, 'a')).second);
+  assert(!kv.insert(keyValuePair(1, 'b')).second);
+  assert(kv.begin()->value == 'a');
+
+  std::cout << std::endl;
+
+}
+
+void testSortedMap(){
+
+  std::cout << "testSortedMap" << std::endl << std::endl;
+
+  SortedMap<int, char, int_crescent> map;
+  assert(map.try_emplace(3, 'c').second);
+  assert(map.try_emplace(1, 'a').second);
+  assert(!map.try_emplace(3, 'x').second);
+  assert(map.find(3)->second == 'c');
+  assert(map.find(2) == map.end());
+
+  map[2] = 'b';
+  assert(map.size() == 3);
+  assert(map[2] == 'b');
+  assert(map.size() == 3);
+
+  std::pair<SortedMap<int, char, int_crescent>::iterator, bool> r = map.insert_or_assign(3, 'z');
+  assert(!r.second);
+  assert(r.first.value() == 'z');
+  r = map.insert_or_assign(0, '0');
+  assert(r.second);
+  assert(r.first.key() == 0);
+
+  int keys[] = {0, 1, 2, 3};
+  int i = 0;
+  for(SortedMap<int, char, int_crescent>::iterator it = map.begin(); it != map.end(); ++it){
+    assert((*it).first == keys[i++]);
+  }
+  assert(map.lower_bound(2).key() == 2);
+  assert(map.upper_bound(2).key() == 3);
+  assert(map.contains(1));
+  assert(map.count(7) == 0);
+
+  assert(map.erase(1) == 1);
+  assert(map.erase(1) == 0);
+  assert(map.size() == 3);
+  assert(map.begin()[1].second == 'b');
+
+  // accesso in sola lettura tramite const_iterator
+  const SortedMap<int, char, int_crescent> &view = map;
+  SortedMap<int, char, int_crescent>::const_iterator cit = view.find(2);
+  assert(cit != view.end() && cit.value() == 'b');
+  assert(view.find(1) == view.end());
+  assert(view.lower_bound(1).key() == 2);
+  assert(view.upper_bound(2).key() == 3);
+  assert(view.end() - view.begin() == 3);
+  cit = map.begin();
+  assert(cit == view.begin());
+
+  SortedMap<int, char, int_crescent> copy(map);
+  map.toEmpty();
+  assert(copy.size() == 3);
+  assert(copy[3] == 'z');
+  map = std::move(copy);
+  assert(map.size() == 3);
+
+  // funtore trasparente: ricerca con const char* senza costruire una std::string
+  SortedMap<std::string, int, std::less<> > words = {{"uno", 1}, {"due", 2}, {"tre", 3}, {"uno", 4}};
+  assert(words.size() == 3);
+  assert(words.find("due")->second == 2);
+  assert(words.contains("tre"));
+  assert(words.find("quattro") == words.end());
+  words.try_emplace("quattro", 4);
+  words["cinque"] = 5;
+  assert(words.size() == 5);
+  assert(words.begin().key() == "cinque");
+
+  // argomenti che si riferiscono a un valore della mappa: vengono letti prima di spostare le coppie
+  const std::string lungo = "un valore abbastanza lungo da essere allocato sullo heap";
+  SortedMap<int, std::string, int_crescent> aliased;
+  aliased.try_emplace(5, lungo);
+  aliased.shrink_to_fit();
+  aliased.try_emplace(1, aliased.begin()->second);
+  aliased.reserve(4);
+  aliased.try_emplace(3, aliased.find(5)->second);
+  assert(aliased.size() == 3);
+  assert(aliased[1] == lungo && aliased[3] == lungo && aliased[5] == lungo);
+
+  // funtore non trasparente: la chiave viene convertita una volta
+  SortedMap<std::string, int, std::less<std::string> > plain = {{"a", 1}};
+  assert(plain.find("a") != plain.end());
+
+  // tipi non banali: chiavi e valori vengono costruiti e distrutti correttamente
+  assert(tracked::alive == 0);
+  {
+    SortedMap<int, tracked, int_crescent> tr;
+    for(int k = 0; k < 50; ++k){
+      tr.try_emplace((k * 7) % 50, k);
+    }
+    assert(tracked::alive == 50);
+    tr.erase(10);
+    assert(tracked::alive == 49);
+    assert(tr.find(7)->second.value == 1);
+  }
+  assert(tracked::alive == 0);
+
+  // allocatori che non si propagano: copia, spostamento e scambio mantengono la risorsa di ogni mappa
+  std::pmr::monotonic_buffer_resource resource;
+  std::pmr::unsynchronized_pool_resource other;
+  {
+    typedef SortedMap<int, std::pmr::string, int_crescent, std::pmr::polymorphic_allocator<int> > pmr_map;
+    pmr_map m1(&resource);
+    m1.try_emplace(2, lungo.c_str());
+    m1.try_emplace(1, "uno");
+    pmr_map m2(&other);
+    m2.try_emplace(7, "sette");
+
+    m2 = m1;
+    assert(m2.get_allocator().resource() == &other);
+    assert(m2.size() == 2 && m2[2] == lungo.c_str());
+    m2 = std::move(m1);
+    assert(m2.get_allocator().resource() == &other);
+    assert(m2.size() == 2 && m1.size() == 0);
+    pmr_map m3(&other);
+    m3.try_emplace(9, "nove");
+    m3.swap(m2);
+    assert(m3.size() == 2 && m2.size() == 1 && m2[9] == "nove");
+    assert(m3.get_allocator().resource() == &other);
+  }
+
+  // politica MINIMAL: la capacità segue il numero di coppie
+  SortedMap<int, char, int_crescent> minimal(SortedMap<int, char, int_crescent>::MINIMAL);
+  for(int k = 0; k < 5; ++k){
+    minimal.try_emplace(k, 'a' + k);
+  }
+  assert(minimal.capacity() == 5);
+  minimal.erase(2);
+  assert(minimal.capacity() == 4);
+  assert(minimal.find(3)->second == 'd');
+
+  // ricerca per chiave in un SortedArray con funtore trasparente
+  SortedArray<keyValuePair, kv_crescent> kv;
+  kv.push(keyValuePair(1, 'a'));
+  kv.push(keyValuePair(5, 'e'));
+  kv.push(keyValuePair(3, 'c'));
+  assert(kv.find(3)->value == 'c');
+  assert(kv.find(4) == kv.end());
+  assert(kv.count(5) == 1);
+  assert(kv.lower_bound(4)->key == 3);
+  assert(kv.upper_bound(5)->key == 3);
+
+  std::cout << std::endl;
+
+}
+
+void testEytzinger(){
+
+  std::cout << "testEytzinger" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  EytzingerIndex<int, int_crescent> index(arr);
+  assert(index.lower_bound(5) == arr.end());
+  assert(!index.contains(5));
+
+  for(int i = 0; i < 1000; ++i){
+    arr.push((i * 37) % 500 * 2);
+  }
+  assert(index.stale());
+  for(int x = -3; x < 1005; ++x){
+    assert(index.lower_bound(x) == arr.lower_bound(x));
+    assert(index.find(x) == arr.find(x));
+  }
+  assert(!index.stale());
+
+  // il primo di più elementi uguali
+  assert(index.lower_bound(10) - arr.begin() == 10);
+
+  arr.remove(10);
+  arr.push(11);
+  assert(index.stale());
+  assert(index.contains(11));
+  assert(index.find(11) == arr.find(11));
+  assert(index.lower_bound(10) == arr.lower_bound(10));
+
+  arr.toEmpty();
+  assert(index.lower_bound(0) == arr.end());
+
+  // ordine decrescente e ricerca per chiave con funtore trasparente
+  SortedArray<keyValuePair, kv_crescent> kv;
+  for(int i = 0; i < 100; ++i){
+    kv.push(keyValuePair(i, 'a' + i % 26));
+  }
+  EytzingerIndex<keyValuePair, kv_crescent> kvIndex(kv);
+  for(int key = -1; key <= 100; ++key){
+    assert(kvIndex.lower_bound(key) == kv.lower_bound(key));
+  }
+  assert(kvIndex.find(42)->value == 'a' + 42 % 26);
+
+  assert(tracked::alive == 0);
+  {
+    SortedArray<tracked, tracked_crescent> tr;
+    for(int i = 0; i < 33; ++i){
+      tr.push(tracked(i));
+    }
+    EytzingerIndex<tracked, tracked_crescent> trIndex(tr);
+    assert(trIndex.find(tracked(17))->value == 17);
+    assert(tracked::alive == 66);
+  }
+  assert(tracked::alive == 0);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Confronta le ricerche di arr con std::lower_bound e std::upper_bound
+ * sugli stessi elementi, per chiavi dentro e fuori dall'intervallo dei valori.
+ * 
+ */
+template<typename T, typename C>
+void checkRicercaSimd(SortedArray<T, C> &arr, int maxKey){
+  std::vector<T> v(arr.begin(), arr.end());
+  for(int x = -2; x <= maxKey + 2; ++x){
+    T key = static_cast<T>(x);
+    assert(arr.lower_bound(key) - arr.begin() == std::lower_bound(v.begin(), v.end(), key, C()) - v.begin());
+    assert(arr.upper_bound(key) - arr.begin() == std::upper_bound(v.begin(), v.end(), key, C()) - v.begin());
+    assert(arr.count(key) == std::upper_bound(v.begin(), v.end(), key, C()) - std::lower_bound(v.begin(), v.end(), key, C()));
+    assert(arr.encountered(key) == (std::find(v.begin(), v.end(), key) != v.end()));
+  }
+}
+
+void testSimd(){
+
+  std::cout << "testSimd" << std::endl << std::endl;
+
+  static_assert(has_simd_order<int, int_crescent>::value, "int_crescent");
+  static_assert(has_simd_order<int, int_decrescent>::value, "int_decrescent");
+  static_assert(has_simd_order<double, std::greater<double> >::value, "std::greater<double>");
+  static_assert(!has_simd_order<int, counting_crescent>::value, "counting_crescent");
+  static_assert(!has_simd_order<keyValuePair, kv_crescent>::value, "kv_crescent");
+
+  // dimensioni attorno ai blocchi di 4, 8 e 16 elementi e array più grandi, con duplicati
+  const int sizes[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 100, 1000};
+  for(int n : sizes){
+    SortedArray<int, int_crescent> up;
+    SortedArray<int, int_decrescent> down;
+    SortedArray<int, std::less<int> > less;
+    SortedArray<double, std::greater<double> > greater;
+    for(int i = 0; i < n; ++i){
+      int value = (i * 7) % (n / 2 + 1) * 2;
+      up.push(value);
+      down.push(value);
+      less.push(value);
+      greater.push(value);
+    }
+    checkRicercaSimd(up, n);
+    checkRicercaSimd(down, n);
+    checkRicercaSimd(less, n);
+    checkRicercaSimd(greater, n);
+  }
+
+  // valori estremi: il confronto vettoriale è con segno
+  SortedArray<int, int_crescent> extremes;
+  for(int i = 0; i < 20; ++i){
+    extremes.push(i % 2 ? INT_MAX - i : INT_MIN + i);
+  }
+  assert(extremes.encountered(INT_MIN) && extremes.encountered(INT_MAX - 1));
+  assert(extremes.lower_bound(0) - extremes.begin() == 10);
+  assert(extremes.upper_bound(INT_MAX) == extremes.end());
+
+  // compattazione di filter su lunghezze non multiple di 8
+  for(int n : sizes){
+    SortedArray<int, int_crescent> arr;
+    std::vector<int> expected;
+    for(int i = 0; i < n; ++i){
+      arr.push(i);
+      if(i % 3 != 0){
+        expected.push_back(i);
+      }
+    }
+    int calls = 0;
+    int removed = arr.filter([&calls](int x){ ++calls; return x % 3 == 0; });
+    assert(calls == n);
+    assert(removed == n - static_cast<int>(expected.size()));
+    assert(std::equal(arr.begin(), arr.end(), expected.begin(), expected.end()));
+  }
+
+  SortedArray<double, std::greater<double> > reals;
+  for(int i = 0; i < 25; ++i){
+    reals.push(i * 0.5);
+  }
+  assert(reals.filter([](double x){ return x > 3; }) == 18);
+  assert(reals.size() == 7 && *reals.begin() == 3 && reals.encountered(0.5));
+
+  std::cout << std::endl;
+
+}
+
+void testRicercaMultipla(){
+
+  std::cout << "testRicercaMultipla" << std::endl << std::endl;
+
+  SortedArray<int, int_crescent> arr;
+  std::vector<bool> found;
+  arr.contains_many(found.begin(), found.begin(), std::back_inserter(found));
+  std::vector<int> none = {1, 2, 3};
+  arr.contains_many(none.begin(), none.end(), std::back_inserter(found));
+  assert(found == std::vector<bool>(3, false));
+
+  for(int i = 0; i < 1000; ++i){
+    arr.push((i * 37) % 500 * 2);
+  }
+
+  // chiavi ordinate, con duplicati e fuori dall'intervallo dei valori
+  std::vector<int> sorted;
+  for(int x = -5; x < 1010; x += 3){
+    sorted.push_back(x);
+    sorted.push_back(x);
+  }
+  // chiavi casuali: le prime sono ordinate, poi le ricerche procedono a gruppi
+  std::vector<int> shuffled;
+  for(int i = 0; i < 1021; ++i){
+    shuffled.push_back((i * 7919) % 1013 - 3);
+  }
+
+  for(const std::vector<int> *keys : {&sorted, &shuffled}){
+    std::vector<SortedArray<int, int_crescent>::iterator> its;
+    found.clear();
+    arr.find_many(keys->begin(), keys->end(), std::back_inserter(its));
+    arr.contains_many(keys->begin(), keys->end(), std::back_inserter(found));
+    assert(its.size() == keys->size() && found.size() == keys->size());
+    for(std::size_t i = 0; i < keys->size(); ++i){
+      assert(its[i] == arr.find((*keys)[i]));
+      assert(found[i] == arr.encountered((*keys)[i]));
+    }
+  }
+
+  // chiavi per un funtore trasparente, in ordine decrescente come l'array
+  SortedArray<keyValuePair, kv_crescent> kv;
+  for(int i = 0; i < 100; i += 2){
+    kv.push(keyValuePair(i, 'a' + i % 26));
+  }
+  int keys[] = {98, 50, 49, 0, -1, 64, 200, 63};
+  bool expected[] = {true, true, false, true, false, true, false, false};
+  bool result[8];
+  assert(kv.contains_many(keys, keys + 8, result) == result + 8);
+  assert(std::equal(result, result + 8, expected));
+  SortedArray<keyValuePair, kv_crescent>::iterator kvIts[8];
+  kv.find_many(keys, keys + 8, kvIts);
+  assert(kvIts[1]->key == 50 && kvIts[2] == kv.end() && kvIts[5]->value == 'a' + 64 % 26);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Tipo con spostamento noexcept che registra l'ordine di inserimento,
+ * per verificare la stabilità dell'ordinamento parallelo.
+ * 
+ */
+struct ranked{
+  int key;
+  int order;
+};
+
+struct ranked_crescent{
+  bool operator()(const ranked &a, const ranked &b) const {
+    return a.key < b.key;
+  }
+};
+
+void testParallelo(){
+
+  std::cout << "testParallelo" << std::endl << std::endl;
+
+  ThreadPool pool(4, 16);
+  assert(pool.concurrency() == 4 && pool.threshold() == 16);
+
+  // bulk esegue ogni indice una volta e rilancia le eccezioni dei compiti
+  std::vector<int> hits(100, 0);
+  pool.bulk(hits.size(), [&hits](std::size_t i){ ++hits[i]; });
+  assert(std::count(hits.begin(), hits.end(), 1) == 100);
+  bool thrown = false;
+  try{
+    pool.bulk(10, [](std::size_t i){ if(i == 7) throw std::runtime_error("bulk"); });
+  } catch(const std::runtime_error &){
+    thrown = true;
+  }
+  assert(thrown);
+
+  // dimensioni sotto la soglia (ordinamento sequenziale), non divisibili per i compiti e grandi
+  const int sizes[] = {0, 1, 31, 32, 33, 257, 5000};
+  for(int n : sizes){
+    std::vector<int> input;
+    for(int i = 0; i < n; ++i){
+      input.push_back((i * 7919) % 1009 - 500);
+    }
+    SortedArray<int, int_crescent> arr(input.begin(), input.end(), pool);
+    std::sort(input.begin(), input.end());
+    assert(arr.size() == n);
+    assert(std::equal(arr.begin(), arr.end(), input.begin(), input.end()));
+  }
+
+  // stabilità: pochi valori distinti, molto ripetuti
+  std::vector<ranked> records;
+  for(int i = 0; i < 3000; ++i){
+    records.push_back(ranked{(i * 31) % 5, i});
+  }
+  SortedArray<ranked, ranked_crescent> stable(records.begin(), records.end(), pool);
+  std::stable_sort(records.begin(), records.end(), ranked_crescent());
+  for(int i = 0; i < 3000; ++i){
+    assert(stable.begin()[i].key == records[i].key && stable.begin()[i].order == records[i].order);
+  }
+
+  // inserimento parallelo: gli elementi già presenti precedono quelli equivalenti inseriti
+  std::vector<ranked> more;
+  for(int i = 0; i < 1000; ++i){
+    more.push_back(ranked{i % 7, 3000 + i});
+  }
+  stable.insert(more.begin(), more.end(), pool);
+  records.insert(records.end(), more.begin(), more.end());
+  std::stable_sort(records.begin(), records.end(), ranked_crescent());
+  assert(stable.size() == 4000);
+  for(int i = 0; i < 4000; ++i){
+    assert(stable.begin()[i].key == records[i].key && stable.begin()[i].order == records[i].order);
+  }
+
+  // ordine decrescente e sort() parallelo di un array già esistente
+  SortedArray<int, int_decrescent> down;
+  std::vector<int> values;
+  for(int i = 0; i < 2000; ++i){
+    values.push_back((i * 37) % 2000);
+  }
+  down.insert(values.begin(), values.end(), pool);
+  down.sort(pool);
+  std::sort(values.begin(), values.end(), int_decrescent());
+  assert(std::equal(down.begin(), down.end(), values.begin(), values.end()));
+
+  std::cout << std::endl;
+
+}
+
+void testConcorrente(){
+
+  std::cout << "testConcorrente" << std::endl << std::endl;
+
+  // le modifiche vengono pubblicate a gruppi di 4
+  ConcurrentSortedArray<int, int_crescent> shared(4);
+  assert(shared.size() == 0 && shared.version() == 0);
+  shared.push(5);
+  shared.push(1);
+  shared.push(3);
+  assert(shared.size() == 0 && !shared.encountered(5));
+  shared.remove(1);
+  assert(shared.version() == 1);
+  assert(shared.size() == 2 && shared.encountered(3) && !shared.encountered(1));
+
+  // un'istantanea non vede le versioni pubblicate dopo la sua creazione
+  {
+    ConcurrentSortedArray<int, int_crescent>::snapshot before = shared.read();
+    shared.push(4);
+    shared.flush();
+    assert(before.size() == 2 && shared.size() == 3);
+    std::vector<int> seen(before.begin(), before.end());
+    assert(seen == std::vector<int>({3, 5}));
+    assert(before.count(5) == 1 && !before.encountered(4));
+  }
+
+  shared.update([](SortedArray<int, int_crescent> &arr){
+    arr.push_many({10, 0, 7});
+    arr.filter(is_even());
+  });
+  {
+    ConcurrentSortedArray<int, int_crescent>::snapshot now = shared.read();
+    std::vector<int> seen(now.begin(), now.end());
+    assert(seen == std::vector<int>({3, 5, 7}));
+  }
+
+  // le versioni sostituite vengono liberate quando nessuna istantanea le riferisce
+  assert(tracked::alive == 0);
+  {
+    SortedArray<tracked, tracked_crescent> initial;
+    initial.push(tracked(1));
+    ConcurrentSortedArray<tracked, tracked_crescent> versions(std::move(initial), 1);
+    {
+      ConcurrentSortedArray<tracked, tracked_crescent>::snapshot old = versions.read();
+      versions.push(tracked(2));
+      versions.push(tracked(3));
+      // le versioni sostituite dopo l'inizio della lettura restano vive
+      assert(old.size() == 1 && old.begin()->value == 1);
+      assert(tracked::alive == 1 + 2 + 3);
+      ConcurrentSortedArray<tracked, tracked_crescent>::snapshot moved(std::move(old));
+      assert(moved.size() == 1);
+    }
+    versions.flush();
+    assert(tracked::alive == 3);
+  }
+  assert(tracked::alive == 0);
+
+  // lettori e scrittori contemporanei: ogni istantanea è ordinata e contiene un prefisso
+  // completo delle scritture, pubblicate a gruppi
+  ConcurrentSortedArray<int, int_crescent> concurrent(16);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for(int t = 0; t < 3; ++t){
+    readers.emplace_back([&concurrent, &done]{
+      while(!done.load()){
+        ConcurrentSortedArray<int, int_crescent>::snapshot snap = concurrent.read();
+        assert(std::is_sorted(snap.begin(), snap.end()));
+        assert(snap.size() % 16 == 0);
+        if(snap.size() > 0){
+          assert(snap.encountered(0) && !snap.encountered(snap.size()));
+        }
+      }
+    });
+  }
+  std::thread writer([&concurrent]{
+    for(int i = 0; i < 2000; ++i){
+      concurrent.push(i);
+    }
+  });
+  writer.join();
+  done.store(true);
+  for(std::thread &t : readers){
+    t.join();
+  }
+  assert(concurrent.size() == 2000 && concurrent.version() == 125);
+
+  std::cout << std::endl;
+
+}
+
+void testLogStrutturato(){
+
+  std::cout << "testLogStrutturato" << std::endl << std::endl;
+
+  // confronto con un SortedArray che riceve gli stessi inserimenti
+  LogSortedArray<int, int_crescent, std::hash<int> > log(8);
+  SortedArray<int, int_crescent> reference;
+  for(int i = 0; i < 1000; ++i){
+    int value = (i * 7919) % 1013;
+    log.push(value);
+    reference.push(value);
+  }
+  assert(log.size() == 1000);
+  // 1000 = 125 buffer pieni: i livelli occupati sono i bit a 1 di 125
+  assert(log.levels() == 6);
+  for(int x = -1; x < 1015; ++x){
+    assert(log.encountered(x) == reference.encountered(x));
+  }
+
+  log.remove(5);
+  assert(reference.remove(5));
+  log.remove(2000);
+  assert(log.size() == 999);
+  assert(log.filter(is_even()) == reference.filter(is_even()));
+  assert(log.encountered(7) && !log.encountered(8));
+
+  // gli iteratori compattano l'array in un solo livello
+  assert(std::equal(log.begin(), log.end(), reference.begin(), reference.end()));
+  assert(log.levels() == 1);
+  log.push(3);
+  log.compact();
+  assert(log.levels() == 1 && log.size() == reference.size() + 1);
+
+  log.toEmpty();
+  assert(log.size() == 0 && log.begin() == log.end() && !log.encountered(3));
+
+  // tra elementi equivalenti l'ordine è quello di inserimento, senza filtri di Bloom
+  LogSortedArray<ranked, ranked_crescent> stable(4);
+  for(int i = 0; i < 50; ++i){
+    stable.push(ranked{i % 3, i});
+  }
+  int previousKey = -1;
+  int previousOrder = -1;
+  for(LogSortedArray<ranked, ranked_crescent>::iterator it = stable.begin(); it != stable.end(); ++it){
+    assert(it->key > previousKey || (it->key == previousKey && it->order > previousOrder));
+    previousKey = it->key;
+    previousOrder = it->order;
+  }
+
+  std::cout << std::endl;
+
+}
+
+void testTiered(){
+
+  std::cout << "testTiered" << std::endl << std::endl;
+
+  // confronto con un SortedArray: oltre 2 * 64 * 64 elementi i blocchi vengono raddoppiati
+  TieredSortedArray<int, int_crescent> tiered;
+  SortedArray<int, int_crescent> reference;
+  assert(tiered.size() == 0 && tiered.begin() == tiered.end());
+  for(int i = 0; i < 12000; ++i){
+    int value = (i * 7919) % 5003;
+    tiered.push(value);
+    reference.push(value);
+  }
+  assert(tiered.size() == 12000 && tiered.blockSize() == 128);
+  assert(std::equal(tiered.begin(), tiered.end(), reference.begin(), reference.end()));
+  for(int i = 0; i < 9000; ++i){
+    int value = (i * 104729) % 5003;
+    tiered.remove(value);
+    reference.remove(value);
+  }
+  tiered.remove(-1);
+  assert(tiered.size() == reference.size());
+  assert(std::equal(tiered.begin(), tiered.end(), reference.begin(), reference.end()));
+  for(int x = -1; x < 5004; x += 7){
+    assert(tiered.encountered(x) == reference.encountered(x));
+    assert(tiered.count(x) == std::count(reference.begin(), reference.end(), x));
+  }
+  assert(tiered.filter(is_even()) == reference.filter(is_even()));
+  assert(std::equal(tiered.begin(), tiered.end(), reference.begin(), reference.end()));
+
+  // iteratore random access
+  TieredSortedArray<int, int_crescent>::iterator it = tiered.lower_bound(101);
+  assert(*it == *std::lower_bound(reference.begin(), reference.end(), 101, int_crescent()));
+  assert(tiered.upper_bound(101) - it == tiered.count(101));
+  assert(it[1] == *(it + 1) && (it + 1) - 1 == it && it < it + 1);
+  assert(tiered.begin() + tiered.size() == tiered.end());
+  assert(tiered.find(2) == tiered.end() && *tiered.find(tiered.begin()[0]) == tiered.begin()[0]);
+  int first = tiered.begin()[0];
+  it = tiered.erase(tiered.begin());
+  assert(it == tiered.begin() && tiered.size() == reference.size() - 1);
+  tiered.push(first);
+
+  TieredSortedArray<int, int_crescent> copy(tiered);
+  tiered.toEmpty();
+  assert(tiered.size() == 0 && tiered.blockSize() == 64);
+  assert(std::equal(copy.begin(), copy.end(), reference.begin(), reference.end()));
+  tiered = std::move(copy);
+  assert(tiered.size() == reference.size() && copy.size() == 0);
+
+  std::vector<int> unsorted;
+  for(int i = 0; i < 300; ++i){
+    unsorted.push_back((i * 31) % 97);
+  }
+  TieredSortedArray<int, int_decrescent> built(unsorted.begin(), unsorted.end());
+  assert(std::is_sorted(built.begin(), built.end(), int_decrescent()));
+  std::cout << TieredSortedArray<int, int_crescent>(unsorted.begin(), unsorted.begin() + 5) << std::endl;
+
+  // tra elementi equivalenti l'ordine è quello di inserimento
+  TieredSortedArray<ranked, ranked_crescent> stable;
+  for(int i = 0; i < 500; ++i){
+    stable.push(ranked{i % 3, i});
+  }
+  for(TieredSortedArray<ranked, ranked_crescent>::iterator r = stable.begin() + 1; r != stable.end(); ++r){
+    assert(r[-1].key < r->key || (r[-1].key == r->key && r[-1].order < r->order));
+  }
+
+  // vengono costruiti e distrutti solo gli elementi presenti
+  assert(tracked::alive == 0);
+  {
+    TieredSortedArray<tracked, tracked_crescent> tr;
+    for(int i = 0; i < 300; ++i){
+      tr.push(tracked((i * 7) % 101));
+    }
+    for(int i = 0; i < 100; ++i){
+      tr.remove(tracked(i));
+    }
+    assert(tracked::alive == tr.size() && tr.size() == 200);
+    tr.filter([](const tracked &t){ return t.value % 2 == 0; });
+    TieredSortedArray<tracked, tracked_crescent> trCopy(tr);
+    assert(tracked::alive == 2 * tr.size());
+  }
+  assert(tracked::alive == 0);
+
+  // la memoria viene scelta con una politica
+  static_assert(std::is_same<sorted_sequence<int, int_crescent>, SortedArray<int, int_crescent> >::value, "flat_storage");
+  static_assert(std::is_same<sorted_sequence<int, int_crescent, tiered_storage>, TieredSortedArray<int, int_crescent> >::value, "tiered_storage");
+  sorted_sequence<int, int_crescent, tiered_storage> sequence;
+  sequence.push(3);
+  sequence.push(1);
+  assert(*sequence.begin() == 1 && sequence.size() == 2);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Tipo banalmente copiabile senza costruttore di default.
+ * 
+ */
+struct stamped{
+  explicit stamped(int v): value(v) {}
+  int value;
+};
+
+struct stamped_crescent{
+  bool operator()(const stamped &a, const stamped &b) const {
+    return a.value < b.value;
+  }
+};
+
+void testMappato(){
+
+  std::cout << "testMappato" << std::endl << std::endl;
+
+  const std::string path = "test_mapped.bin";
+  SortedArray<int, int_crescent> reference;
+  for(int i = 0; i < 5000; ++i){
+    reference.push((i * 7919) % 3001);
+  }
+  MappedSortedArray<int, int_crescent>::save(path, reference);
+
+  {
+    // gli elementi vengono letti dalla mappatura, senza copie né riordinamenti
+    MappedSortedArray<int, int_crescent> mapped(path);
+#if defined(SORTEDARRAY_MMAP)
+    assert(mapped.mapped());
+#endif
+    assert(mapped.size() == reference.size());
+    assert(std::equal(mapped.begin(), mapped.end(), reference.begin(), reference.end()));
+    for(int x = -1; x < 3002; x += 5){
+      assert(mapped.encountered(x) == reference.encountered(x));
+      assert(mapped.count(x) == reference.count(x));
+    }
+    assert(*mapped.lower_bound(100) == *reference.lower_bound(100));
+    assert(mapped.find(-5) == mapped.end() && *mapped.find(42) == 42);
+
+    // la prima modifica copia gli elementi in memoria, il file non cambia
+    MappedSortedArray<int, int_crescent> moved(std::move(mapped));
+    assert(moved.size() == reference.size() && mapped.size() == 0);
+    moved.push(-7);
+    moved.remove(42);
+    assert(!moved.mapped() && moved.size() == reference.size());
+    assert(*moved.begin() == -7 && moved.count(42) == reference.count(42) - 1);
+    assert(moved.filter(is_even()) > 0 && std::none_of(moved.begin(), moved.end(), is_even()));
+
+    MappedSortedArray<int, int_crescent> reopened(path);
+    assert(std::equal(reopened.begin(), reopened.end(), reference.begin(), reference.end()));
+    // save() su un file mappato lo sostituisce senza invalidare la mappatura
+    moved.save(path);
+    assert(std::equal(reopened.begin(), reopened.end(), reference.begin(), reference.end()));
+    MappedSortedArray<int, int_crescent> saved(path);
+    assert(std::equal(saved.begin(), saved.end(), moved.begin(), moved.end()));
+  }
+
+  // file incompatibili: altro funtore, altro tipo, file assente o troncato
+  bool rejected = false;
+  try{
+    MappedSortedArray<int, int_decrescent> wrong(path);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+  rejected = false;
+  try{
+    MappedSortedArray<short, std::less<short> > wrong(path);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+  rejected = false;
+  try{
+    MappedSortedArray<int, int_crescent> missing("missing_mapped.bin");
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+  std::FILE *truncated = std::fopen(path.c_str(), "wb");
+  std::fputs("SORTARR", truncated);
+  std::fclose(truncated);
+  rejected = false;
+  try{
+    MappedSortedArray<int, int_crescent> wrong(path);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+
+  // tipo non aritmetico e funtore decrescente, array vuoto
+  SortedArray<keyValuePair, kv_crescent> pairs;
+  for(int i = 0; i < 100; ++i){
+    pairs.push(keyValuePair(i % 10, 'a' + i % 26));
+  }
+  MappedSortedArray<keyValuePair, kv_crescent>::save(path, pairs);
+  {
+    MappedSortedArray<keyValuePair, kv_crescent> mapped(path);
+    assert(std::equal(mapped.begin(), mapped.end(), pairs.begin(), pairs.end(),
+      [](keyValuePair a, keyValuePair b){ return a == b; }));
+    assert(mapped.count(keyValuePair(3, 'x')) == 10);
+    assert(mapped.encountered(keyValuePair(3, 'd')) && !mapped.encountered(keyValuePair(3, 'e')));
+  }
+  // il tipo non deve avere un costruttore di default, anche senza mappatura
+  SortedArray<stamped, stamped_crescent> stamps;
+  for(int i = 0; i < 50; ++i){
+    stamps.emplace((i * 13) % 50);
+  }
+  MappedSortedArray<stamped, stamped_crescent>::save(path, stamps);
+  {
+    MappedSortedArray<stamped, stamped_crescent> mapped(path);
+    assert(mapped.size() == 50 && mapped.begin()->value == 0 && (mapped.end() - 1)->value == 49);
+  }
+  MappedSortedArray<int, int_crescent>::save(path, SortedArray<int, int_crescent>());
+  {
+    MappedSortedArray<int, int_crescent> empty(path);
+    assert(empty.size() == 0 && empty.begin() == empty.end() && !empty.encountered(0));
+  }
+  std::remove(path.c_str());
+
+  // lettura diretta nella memoria dell'array, usata dall'apertura senza mmap
+  SortedArray<int, int_crescent> direct;
+  direct.push(1);
+  assert(direct.append_sorted_raw(3, [](int *dst){ dst[0] = 2; dst[1] = 3; dst[2] = 5; return true; }));
+  assert(!direct.append_sorted_raw(2, [](int *){ return false; }));
+  assert(direct.size() == 4 && direct.encountered(5) && *(direct.end() - 1) == 5);
+
+  std::cout << std::endl;
+
+}
+
+void testSerializzazione(){
+
+  std::cout << "testSerializzazione" << std::endl << std::endl;
+
+  // operator<< scrive sullo stream ricevuto
+  SortedArray<int, int_crescent> small;
+  small.push_many({3, 1, 2});
+  std::ostringstream text;
+  text << small;
+  assert(text.str().find("Elementi in ordine: 1 2 3 ") != std::string::npos);
+
+  SortedArray<int, int_crescent> reference;
+  for(int i = 0; i < 1000; ++i){
+    reference.push((i * 7919) % 601);
+  }
+
+  // buffer e stream, in blocchi da 64 elementi
+  std::vector<char> buffer;
+  serialize(reference, buffer, raw_codec<int>(), 64);
+  SortedArray<int, int_crescent> loaded;
+  loaded.push(-1);
+  deserialize(loaded, buffer);
+  assert(std::equal(loaded.begin(), loaded.end(), reference.begin(), reference.end()));
+  std::stringstream stream;
+  serialize(reference, stream);
+  SortedArray<int, int_crescent> streamed;
+  deserialize(streamed, stream, TRUST_SORTED);
+  assert(std::equal(streamed.begin(), streamed.end(), reference.begin(), reference.end()));
+
+  // con un altro funtore gli elementi vengono riordinati anche con TRUST_SORTED
+  SortedArray<int, int_decrescent> reversed;
+  deserialize(reversed, buffer, TRUST_SORTED);
+  assert(reversed.size() == reference.size() && std::is_sorted(reversed.begin(), reversed.end(), int_decrescent()));
+
+  // dati danneggiati, troncati o scritti con un altro codec
+  std::vector<char> corrupted(buffer);
+  corrupted[corrupted.size() / 2] ^= 1;
+  bool rejected = false;
+  try{
+    deserialize(loaded, corrupted);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected && loaded.size() == reference.size());
+  // intestazione danneggiata, oppure con un numero di elementi falso ma checksum valido:
+  // il caricamento fallisce senza riservare memoria per gli elementi dichiarati
+  sorted_array_serialization::header header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  header.count = std::numeric_limits<int>::max();
+  std::memcpy(corrupted.data(), &header, sizeof(header));
+  rejected = false;
+  try{
+    deserialize(loaded, corrupted);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+  header.checksum = sorted_array_serialization::headerChecksum(header);
+  std::vector<char> inflated(buffer);
+  std::memcpy(inflated.data(), &header, sizeof(header));
+  rejected = false;
+  try{
+    deserialize(loaded, inflated);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected && loaded.size() == reference.size());
+  std::vector<char> truncated(buffer.begin(), buffer.end() - 5);
+  rejected = false;
+  try{
+    deserialize(loaded, truncated);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+  rejected = false;
+  try{
+    SortedArray<short, std::less<short> > wrong;
+    deserialize(wrong, buffer);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+
+  // codec definito dall'utente: 5 byte per keyValuePair invece di 8
+  auto codec = make_codec<keyValuePair>(
+    [](const keyValuePair &kv, codec_writer &out){ out.put(kv.key); out.put(kv.value); },
+    [](codec_reader &in){ int key = in.get<int>(); return keyValuePair(key, in.get<char>()); });
+  SortedArray<keyValuePair, kv_crescent> pairs;
+  for(int i = 0; i < 200; ++i){
+    pairs.push(keyValuePair(i % 17, 'a' + i % 26));
+  }
+  std::vector<char> encoded;
+  serialize(pairs, encoded, codec, 50);
+  assert(encoded.size() < pairs.size() * sizeof(keyValuePair));
+  SortedArray<keyValuePair, kv_crescent> decoded;
+  deserialize(decoded, encoded, VERIFY_ORDER, codec);
+  assert(std::equal(decoded.begin(), decoded.end(), pairs.begin(), pairs.end(),
+    [](keyValuePair a, keyValuePair b){ return a == b; }));
+  rejected = false;
+  try{
+    deserialize(decoded, encoded);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected);
+
+  // blocco con un numero di byte falso: la lettura fallisce senza allocare i byte dichiarati
+  std::vector<char> oversized(encoded);
+  sorted_array_serialization::chunk_header chunkHeader;
+  std::memcpy(&chunkHeader, oversized.data() + sizeof(header), sizeof(chunkHeader));
+  chunkHeader.bytes = std::numeric_limits<std::uint32_t>::max();
+  std::memcpy(oversized.data() + sizeof(header), &chunkHeader, sizeof(chunkHeader));
+  rejected = false;
+  try{
+    deserialize(decoded, oversized, VERIFY_ORDER, codec);
+  } catch(const std::runtime_error &){
+    rejected = true;
+  }
+  assert(rejected && decoded.size() == pairs.size());
+
+  // checksum di un intervallo vuoto, anche senza memoria
+  assert(sorted_array_checksum(nullptr, 0) == sorted_array_checksum(encoded.data(), 0));
+
+  // gli elementi non ordinati vengono ordinati in modo stabile
+  SortedArray<ranked, ranked_crescent> unordered;
+  for(int i = 0; i < 30; ++i){
+    unordered.push(ranked{0, i});
+  }
+  SortedArray<ranked, ranked_crescent>::iterator it = unordered.begin();
+  for(int i = 0; i < 30; ++i, ++it){
+    it->key = (i * 7) % 3;
+  }
+  std::vector<char> raw;
+  serialize(unordered, raw, raw_codec<ranked>(), 8);
+  SortedArray<ranked, ranked_crescent> sorted;
+  deserialize(sorted, raw);
+  for(it = sorted.begin() + 1; it != sorted.end(); ++it){
+    assert(it[-1].key < it->key || (it[-1].key == it->key && it[-1].order < it->order));
+  }
+
+  // array vuoto
+  std::vector<char> empty;
+  serialize(SortedArray<int, int_crescent>(), empty);
+  deserialize(loaded, empty);
+  assert(loaded.size() == 0);
+
+  std::cout << std::endl;
+
+}
+
+/**
+ * @brief Verifica che compressed contenga gli stessi elementi di reference, nello stesso ordine,
+ * e che le ricerche diano gli stessi risultati.
+ * 
+ */
+template<typename C>
+void checkCompresso(const CompressedSortedIntArray<C> &compressed, SortedArray<int, C> &reference, const std::vector<int> &probes){
+  assert(compressed.size() == reference.size());
+  typename CompressedSortedIntArray<C>::scan_range values = compressed.scan();
+  assert(std::equal(values.begin(), values.end(), reference.begin(), reference.end()));
+  // begin() ricomincia la scansione dal primo blocco
+  assert(std::equal(values.begin(), values.end(), reference.begin(), reference.end()));
+  SortedArray<int, C> decompressed = compressed.decompress();
+  assert(std::equal(decompressed.begin(), decompressed.end(), reference.begin(), reference.end()));
+  int visited = 0;
+  compressed.for_each([&](int x){ assert(x == reference.begin()[visited]); ++visited; });
+  assert(visited == reference.size());
+  for(int x : probes){
+    assert(compressed.encountered(x) == reference.encountered(x));
+    assert(compressed.lowerIndex(x) == reference.lower_bound(x) - reference.begin());
+    assert(compressed.upperIndex(x) == reference.upper_bound(x) - reference.begin());
+    assert(compressed.count(x) == reference.count(x));
+  }
+}
+
+void testCompresso(){
+
+  std::cout << "testCompresso" << std::endl << std::endl;
+
+  // identificatori densi, con duplicati e qualche salto lungo (eccezioni)
+  SortedArray<int, int_crescent> ids;
+  std::vector<int> probes;
+  int id = -1000;
+  for(int i = 0; i < 10000; ++i){
+    id += (i * 7919) % 5 + (i % 997 == 0 ? 1000000 : 0);
+    ids.push(id);
+  }
+  for(int i = 0; i < 2000; ++i){
+    probes.push_back(ids.begin()[(i * 31) % ids.size()] + i % 3 - 1);
+  }
+  probes.push_back(INT_MIN);
+  probes.push_back(INT_MAX);
+  CompressedSortedIntArray<int_crescent> compressed(ids);
+  checkCompresso(compressed, ids, probes);
+  assert(compressed.bytes() * 3 < ids.size() * sizeof(int));
+
+  // ordine decrescente
+  SortedArray<int, int_decrescent> descending(ids.begin(), ids.end());
+  CompressedSortedIntArray<int_decrescent> compressedDescending(descending);
+  checkCompresso(compressedDescending, descending, probes);
+
+  // estremi di int (differenze di 32 bit) e blocchi incompleti
+  for(int n : {0, 1, 127, 128, 129, 300}){
+    SortedArray<int, std::less<int> > extremes;
+    for(int i = 0; i < n; ++i){
+      extremes.push(i % 3 == 0 ? INT_MIN + i : (i % 3 == 1 ? INT_MAX - i : i));
+    }
+    CompressedSortedIntArray<> small(extremes);
+    checkCompresso(small, extremes, probes);
+    CompressedSortedIntArray<>::scan_range values = small.scan();
+    assert((values.begin() == values.end()) == (n == 0));
+  }
+
+  std::cout << std::endl;
+
+}
 
 int main(int argc, char* argv[]){
 
@@ -404,4 +2116,29 @@ int main(int argc, char* argv[]){
     testFilter();
     testEncountered();
     testCustom();
+    testCapacita();
+    testPushStabile();
+    testRicerca();
+    testErase();
+    testPartitionOut();
+    testInsert();
+    testSort();
+    testMove();
+    testMemoria();
+    testAllocatori();
+    testStatistiche();
+    testInsiemi();
+    testUnique();
+    testSortedSet();
+    testSortedMap();
+    testEytzinger();
+    testSimd();
+    testRicercaMultipla();
+    testParallelo();
+    testConcorrente();
+    testLogStrutturato();
+    testTiered();
+    testMappato();
+    testSerializzazione();
+    testCompresso();
 }
\ No newline at end of file